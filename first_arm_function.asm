@@ -10,29 +10,16 @@ _rgbToHsvBatch:
     stp x29, x30, [sp, #-16]!
     mov x29, sp
     // Arguments: x0=src(float*), x1=dst(float*), x2=count
+    // Only v0-v7 and v16-v31 are used: d8-d15 are callee-saved
+    mov w2, w2            // count is an int: clear the undefined upper half
     cbz x2, 200f
 
     // vector loop count (4 pixels per iteration)
     lsr x3, x2, #2        // x3 = count / 4
     and x4, x2, #3        // x4 = count % 4
 
-    // Prepare constants: eps = 1/1024, one = 1.0, two=2.0, four=4.0, sixty=60.0
-    // compute scalar eps in s0
-    mov w8, #1
-    scvtf s0, w8
-    mov w8, #1024
-    scvtf s1, w8
-    fdiv s0, s0, s1       // s0 = 1/1024
-    // build vector eps v20 from integer dup + scvtf
-    mov w8, #1
-    dup v19.4s, w8        // int vector with 1
-    mov w8, #1024
-    dup v18.4s, w8        // int vector with 1024
-    scvtf v19.4s, v19.4s  // v19 = 1.0
-    scvtf v18.4s, v18.4s  // v18 = 1024.0
-    fdiv v20.4s, v19.4s, v18.4s  // v20 = 1/1024
-
-    // build other vector constants via dup+scvtf
+    // build vector constants via dup+scvtf (kept for the whole call)
+    movi v27.4s, #0        // v27 = 0.0
     mov w8, #1
     dup v21.4s, w8
     scvtf v21.4s, v21.4s   // v21 = 1.0
@@ -45,110 +32,126 @@ _rgbToHsvBatch:
     mov w8, #60
     dup v24.4s, w8
     scvtf v24.4s, v24.4s   // v24 = 60.0
+    mov w8, #360
+    dup v28.4s, w8
+    scvtf v28.4s, v28.4s   // v28 = 360.0
 
-10:
-    cbz x3, 20f
-    // load 4 pixels (interleaved RGB floats)
-    ld3 {v0.4s, v1.4s, v2.4s}, [x0], #48
+// HSV of 4 interleaved RGB pixels at [x12] into [x13], both advanced by 48
+.macro HSV4
+    ld3 {v0.4s, v1.4s, v2.4s}, [x12], #48
 
-    // vmax = max(R,G,B)
+    // vmax = max(R,G,B), vmin = min(R,G,B), delta = vmax - vmin
     fmax v3.4s, v0.4s, v1.4s
     fmax v3.4s, v3.4s, v2.4s
-    // vmin = min(R,G,B)
     fmin v4.4s, v0.4s, v1.4s
     fmin v4.4s, v4.4s, v2.4s
-    // delta = vmax - vmin
     fsub v5.4s, v3.4s, v4.4s
 
-    // S = delta / (vmax + eps)
-    fadd v6.4s, v3.4s, v20.4s
-    fdiv v6.4s, v5.4s, v6.4s
-
-    // inv_delta = 1.0 / (delta + eps)
-    fadd v8.4s, v5.4s, v20.4s
-    fdiv v8.4s, v21.4s, v8.4s
-
-    // t_r = (g - b) * inv_delta
-    fsub v9.4s, v1.4s, v2.4s
-    fmul v9.4s, v9.4s, v8.4s
-
-    // t_g = (b - r) * inv_delta + 2.0
-    fsub v10.4s, v2.4s, v0.4s
-    fmul v10.4s, v10.4s, v8.4s
-    fadd v10.4s, v10.4s, v22.4s
-
-    // t_b = (r - g) * inv_delta + 4.0
-    fsub v11.4s, v0.4s, v1.4s
-    fmul v11.4s, v11.4s, v8.4s
-    fadd v11.4s, v11.4s, v23.4s
-
-    // multiply by 60.0 to get degrees
-    fmul v12.4s, v9.4s, v24.4s   // Hr
-    fmul v13.4s, v10.4s, v24.4s  // Hg
-    fmul v14.4s, v11.4s, v24.4s  // Hb
+    // S = delta / vmax, 0 where vmax == 0 (as rgbToHsvCpp)
+    fdiv v6.4s, v5.4s, v3.4s
+    fcmeq v26.4s, v3.4s, v27.4s
+    mvn v26.16b, v26.16b
+    and v6.16b, v6.16b, v26.16b
+
+    // inv_delta = 1.0 / delta (inf where delta == 0; H is zeroed there)
+    fdiv v7.4s, v21.4s, v5.4s
+
+    // Hr = (g - b) * inv_delta * 60, plus 360 where g < b (hue in [0, 360))
+    fsub v16.4s, v1.4s, v2.4s
+    fmul v16.4s, v16.4s, v7.4s
+    fmul v16.4s, v16.4s, v24.4s
+    fcmge v26.4s, v1.4s, v2.4s
+    mvn v26.16b, v26.16b
+    and v26.16b, v26.16b, v28.16b
+    fadd v16.4s, v16.4s, v26.4s
+
+    // Hg = ((b - r) * inv_delta + 2.0) * 60
+    fsub v17.4s, v2.4s, v0.4s
+    fmul v17.4s, v17.4s, v7.4s
+    fadd v17.4s, v17.4s, v22.4s
+    fmul v17.4s, v17.4s, v24.4s
+
+    // Hb = ((r - g) * inv_delta + 4.0) * 60
+    fsub v18.4s, v0.4s, v1.4s
+    fmul v18.4s, v18.4s, v7.4s
+    fadd v18.4s, v18.4s, v23.4s
+    fmul v18.4s, v18.4s, v24.4s
 
     // masks: which channel equals vmax
-    fcmeq v15.4s, v0.4s, v3.4s   // mask_r
-    fcmeq v16.4s, v1.4s, v3.4s   // mask_g
-
-    // select between Hg and Hb based on mask_g
-    and v17.16b, v16.16b, v13.16b
-    mvn v18.16b, v16.16b
-    and v19.16b, v18.16b, v14.16b
-    orr v20.16b, v17.16b, v19.16b   // v20 = Hg or Hb
-
-    // final H = mask_r ? Hr : v20
-    and v21.16b, v15.16b, v12.16b
-    mvn v22.16b, v15.16b
-    and v23.16b, v22.16b, v20.16b
-    orr v24.16b, v21.16b, v23.16b   // v24 = H
-
-    // zero H where delta <= eps
-    fcmle v25.4s, v5.4s, v20.4s
-    mvn v26.16b, v25.16b
-    and v24.16b, v24.16b, v26.16b
-
-    // move H,S,V into consecutive regs v0,v1,v2 for st3
-    mov v0.16b, v24.16b
+    fcmeq v19.4s, v0.4s, v3.4s   // mask_r
+    fcmeq v25.4s, v1.4s, v3.4s   // mask_g
+
+    // v17 = mask_g ? Hg : Hb
+    and v17.16b, v17.16b, v25.16b
+    mvn v25.16b, v25.16b
+    and v18.16b, v18.16b, v25.16b
+    orr v17.16b, v17.16b, v18.16b
+
+    // H = mask_r ? Hr : v17
+    and v16.16b, v16.16b, v19.16b
+    mvn v19.16b, v19.16b
+    and v17.16b, v17.16b, v19.16b
+    orr v16.16b, v16.16b, v17.16b
+
+    // zero H where delta == 0
+    fcmeq v26.4s, v5.4s, v27.4s
+    mvn v26.16b, v26.16b
+
+    // H,S,V into consecutive regs v0,v1,v2 for st3
+    and v0.16b, v16.16b, v26.16b
     mov v1.16b, v6.16b
     mov v2.16b, v3.16b
-    st3 {v0.4s, v1.4s, v2.4s}, [x1], #48
+    st3 {v0.4s, v1.4s, v2.4s}, [x13], #48
+.endm
 
+    mov x12, x0
+    mov x13, x1
+10:
+    cbz x3, 20f
+    HSV4
     subs x3, x3, #1
     b.ne 10b
 
 20:
-    // scalar tail for remaining pixels
+    // tail: the remaining 1-3 pixels go through the same vector code in a
+    // zero-padded 4-pixel block on the stack, so they match the loop exactly
     cbz x4, 200f
-    mov x5, x2
-    and x5, x5, #3
-    // compute start index = count - x5
-    sub x6, x2, x5
+    sub sp, sp, #96
+    mov x9, sp
+    fmov s7, #0.0
     mov x7, #0
 21:
-    cmp x7, x5
-    bge 200f
-    // load pixel at index (x6 + x7)
-    add x8, x0, x6, LSL #2
+    add x8, x9, x7, LSL #2
+    str s7, [x8]
+    add x7, x7, #1
+    cmp x7, #12
+    b.lt 21b
+
+    add x5, x4, x4, LSL #1    // floats to copy = remaining pixels * 3
+    mov x7, #0
+22:
+    add x8, x12, x7, LSL #2
     ldr s0, [x8]
-    ldr s1, [x8, #4]
-    ldr s2, [x8, #8]
-    fmax s3, s0, s1
-    fmax s3, s3, s2
-    fmin s4, s0, s1
-    fmin s4, s4, s2
-    fsub s5, s3, s4
-    fadd s6, s3, s0
-    fdiv s6, s5, s6
-    fmov s7, #0.0
-    add x9, x1, x6, LSL #2
-    str s7, [x9]
-    str s6, [x9, #4]
-    str s3, [x9, #8]
+    add x8, x9, x7, LSL #2
+    str s0, [x8]
     add x7, x7, #1
-    add x6, x6, #1
+    cmp x7, x5
+    b.lt 22b
+
+    mov x14, x13
+    mov x12, x9
+    add x13, x9, #48
+    HSV4
 
-    b 21b
+    mov x7, #0
+23:
+    add x8, x9, x7, LSL #2
+    ldr s0, [x8, #48]
+    add x8, x14, x7, LSL #2
+    str s0, [x8]
+    add x7, x7, #1
+    cmp x7, x5
+    b.lt 23b
 
 200:
     mov sp, x29
@@ -158,7 +161,8 @@ _rgbToHsvBatch:
 .globl _sobelGradients
 .p2align 2
 _sobelGradients:
-    // x0=imageData, x1=width, x2=height, x3=stride, x4=startY, x5=endY, x6=outGx, x7=outGy
+    // x0=imageData, x1=width, x2=height, x3=rowStride (bytes), x4=startY, x5=endY, x6=outGx, x7=outGy
+    // [sp]=lumaBuffer (9th argument, passed on the stack; width*height floats)
     
     // Prologue
     stp x29, x30, [sp, #-64]!
@@ -168,6 +172,13 @@ _sobelGradients:
     stp x21, x22, [sp, #32]
     stp x23, x24, [sp, #48] 
 
+    // The int arguments only define the low 32 bits of their registers
+    sxtw x1, w1
+    sxtw x2, w2
+    sxtw x3, w3
+    sxtw x4, w4
+    sxtw x5, w5
+
     // Move arguments to safe registers
     mov x19, x1     // width
     mov x20, x2     // height
@@ -176,24 +187,21 @@ _sobelGradients:
     
     // Temporary setup
     mov x9, x0      // imageData
-    mov x10, x3     // stride
+    mov x10, x3     // row stride (bytes)
     mov x11, x4     // startY
     mov x12, x5     // endY
 
-    // Load global luma buffer pointer
-    adrp x8, _g_lumaBuffer@PAGE
-    ldr x21, [x8, _g_lumaBuffer@PAGEOFF]
+    // Load caller-provided luma buffer (stack argument, above our 64-byte frame)
+    ldr x21, [x29, #64]
     cbz x21, .sobel_epilogue 
 
     // ==========================================
     // 1. FILL LUMA BUFFER (Grayscale conversion)
     // ==========================================
     
-    mul x13, x19, x20  // total pixels
-    
-    mov x0, x9      // src ptr
-    mov x1, x21     // dst ptr
-    mov x2, #0      // loop counter
+    // Rows may be padded (stride > width*3), so the fill walks row by row
+    mov x1, x21     // dst ptr (luma rows are packed)
+    mov x14, #0     // row counter
 
     // --- POPRAWKA 1: Ładowanie 255000 (0x3E3F8) ---
     // 255000 nie mieści się w zwykłym mov (limit 16 bitów).
@@ -222,9 +230,17 @@ _sobelGradients:
     scvtf v2.4s, v2.4s
     fdiv v2.4s, v2.4s, v3.4s 
 
+.luma_row:
+    cmp x14, x20
+    bge .luma_done
+    mul x8, x14, x10
+    add x0, x9, x8  // src ptr at the row start
+    mov x13, x19    // pixels in the row
+    mov x2, #0      // loop counter
+
 .luma_loop_entry:
     cmp x2, x13
-    bge .luma_done
+    bge .luma_row_done
     
     sub x8, x13, x2
     cmp x8, #8
@@ -278,12 +294,12 @@ _sobelGradients:
     
     // --- POPRAWKA 2: Użyj 'mov' zamiast 'fmov' ---
     mov s7, v0.s[0]
-    mov s8, v1.s[0]
+    mov s17, v1.s[0]
     // s24 (float) vs x24 (int) - to różne rejestry, jest ok
     mov s24, v2.s[0]
     
     fmul s4, s4, s7
-    fmadd s4, s5, s8, s4
+    fmadd s4, s5, s17, s4
     fmadd s4, s6, s24, s4
     
     str s4, [x1], #4
@@ -291,6 +307,10 @@ _sobelGradients:
     cmp x2, x13
     blt .luma_scalar_tail
 
+.luma_row_done:
+    add x14, x14, #1
+    b .luma_row
+
 .luma_done:
 
     // ==========================================
@@ -360,10 +380,10 @@ _sobelGradients:
     add x8, x15, #4
     ld1 {v7.4s}, [x8]
     add x8, x15, #8
-    ld1 {v8.4s}, [x8]
+    ld1 {v27.4s}, [x8]
     
     // Gx
-    fadd v16.4s, v2.4s, v8.4s   
+    fadd v16.4s, v2.4s, v27.4s   
     fadd v17.4s, v5.4s, v5.4s   
     fadd v16.4s, v16.4s, v17.4s 
     
@@ -374,7 +394,7 @@ _sobelGradients:
     fsub v20.4s, v16.4s, v18.4s 
     
     // Gy
-    fadd v16.4s, v6.4s, v8.4s   
+    fadd v16.4s, v6.4s, v27.4s   
     fadd v17.4s, v7.4s, v7.4s   
     fadd v16.4s, v16.4s, v17.4s 
     
@@ -398,7 +418,7 @@ _sobelGradients:
     bge .sobel_next_row
     
     lsl x8, x5, #2
-    add x14, x21, x8  
+    add x14, x2, x8   // current luma row + column
     
     sub x9, x14, x24  
     ldr s0, [x9, #-4] 
@@ -411,10 +431,10 @@ _sobelGradients:
     add x9, x14, x24  
     ldr s6, [x9, #-4] 
     ldr s7, [x9]      
-    ldr s8, [x9, #4]  
+    ldr s27, [x9, #4]  
     
     // Gx
-    fadd s16, s2, s8
+    fadd s16, s2, s27
     fadd s17, s5, s5
     fadd s16, s16, s17
     
@@ -424,7 +444,7 @@ _sobelGradients:
     fsub s20, s16, s18
     
     // Gy
-    fadd s16, s6, s8
+    fadd s16, s6, s27
     fadd s17, s7, s7
     fadd s16, s16, s17
     
@@ -449,4 +469,115 @@ _sobelGradients:
     ldp x19, x20, [sp, #16]
     mov sp, x29
     ldp x29, x30, [sp], #64
-    ret
\ No newline at end of file
+    ret
+
+.globl _brailleDots
+.p2align 2
+_brailleDots:
+    // x0=levels (4 rows of 2*cols bytes), x1=rowStride, x2=cols, x3=threshold, x4=out
+    // Dot i of a cell is lit where its byte is > threshold (unsigned); bits
+    // follow U+2800: left column 0x01 0x02 0x04 0x40, right 0x08 0x10 0x20 0x80
+    sxtw x1, w1
+    sxtw x2, w2
+    and w3, w3, #0xff
+    cmp x2, #0
+    b.le .braille_done
+
+    add x5, x0, x1      // row 1
+    add x6, x5, x1      // row 2
+    add x7, x6, x1      // row 3
+
+    dup v16.16b, w3     // threshold
+    movi v20.16b, #0x01 // row 0 left / right
+    movi v21.16b, #0x08
+    movi v22.16b, #0x02 // row 1
+    movi v23.16b, #0x10
+    movi v24.16b, #0x04 // row 2
+    movi v25.16b, #0x20
+    movi v26.16b, #0x40 // row 3
+    movi v27.16b, #0x80
+
+.braille_vec_loop:
+    // 16 cells per iteration: ld2 splits each row into left/right dot columns
+    cmp x2, #16
+    b.lt .braille_tail
+    ld2 {v0.16b, v1.16b}, [x0], #32
+    ld2 {v2.16b, v3.16b}, [x5], #32
+    ld2 {v4.16b, v5.16b}, [x6], #32
+    ld2 {v6.16b, v7.16b}, [x7], #32
+
+    // Compare to all-ones lanes, keep each lane's dot bit, OR the 8 dots together
+    cmhi v0.16b, v0.16b, v16.16b
+    cmhi v1.16b, v1.16b, v16.16b
+    cmhi v2.16b, v2.16b, v16.16b
+    cmhi v3.16b, v3.16b, v16.16b
+    cmhi v4.16b, v4.16b, v16.16b
+    cmhi v5.16b, v5.16b, v16.16b
+    cmhi v6.16b, v6.16b, v16.16b
+    cmhi v7.16b, v7.16b, v16.16b
+    and v0.16b, v0.16b, v20.16b
+    and v1.16b, v1.16b, v21.16b
+    and v2.16b, v2.16b, v22.16b
+    and v3.16b, v3.16b, v23.16b
+    and v4.16b, v4.16b, v24.16b
+    and v5.16b, v5.16b, v25.16b
+    and v6.16b, v6.16b, v26.16b
+    and v7.16b, v7.16b, v27.16b
+    orr v0.16b, v0.16b, v1.16b
+    orr v2.16b, v2.16b, v3.16b
+    orr v4.16b, v4.16b, v5.16b
+    orr v6.16b, v6.16b, v7.16b
+    orr v0.16b, v0.16b, v2.16b
+    orr v4.16b, v4.16b, v6.16b
+    orr v0.16b, v0.16b, v4.16b
+    st1 {v0.16b}, [x4], #16
+
+    sub x2, x2, #16
+    b .braille_vec_loop
+
+.braille_tail:
+    cbz x2, .braille_done
+    mov w9, #0
+    ldrb w10, [x0]
+    cmp w10, w3
+    cset w11, hi
+    orr w9, w9, w11
+    ldrb w10, [x0, #1]
+    cmp w10, w3
+    cset w11, hi
+    orr w9, w9, w11, lsl #3
+    ldrb w10, [x5]
+    cmp w10, w3
+    cset w11, hi
+    orr w9, w9, w11, lsl #1
+    ldrb w10, [x5, #1]
+    cmp w10, w3
+    cset w11, hi
+    orr w9, w9, w11, lsl #4
+    ldrb w10, [x6]
+    cmp w10, w3
+    cset w11, hi
+    orr w9, w9, w11, lsl #2
+    ldrb w10, [x6, #1]
+    cmp w10, w3
+    cset w11, hi
+    orr w9, w9, w11, lsl #5
+    ldrb w10, [x7]
+    cmp w10, w3
+    cset w11, hi
+    orr w9, w9, w11, lsl #6
+    ldrb w10, [x7, #1]
+    cmp w10, w3
+    cset w11, hi
+    orr w9, w9, w11, lsl #7
+    strb w9, [x4], #1
+
+    add x0, x0, #2
+    add x5, x5, #2
+    add x6, x6, #2
+    add x7, x7, #2
+    sub x2, x2, #1
+    b .braille_tail
+
+.braille_done:
+    ret
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "image_converter.h"
+#include "raw_loader.h"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// -------------------- ASCII ARCHIVE --------------------
+// Compact on-disk format for sequences of AsciiPixel grids (.a2a).
+//
+//   header   "A2A1", version, width, height, frameCount, flags, indexOffset
+//   frames   per frame: glyph plane, then color plane (if kArchiveColors)
+//   index    frameCount x { uint64 offset, uint32 size, uint32 flags }
+//
+// Index flags: bit 0 marks a keyframe, bits 8-31 hold the frame's display
+// time in milliseconds (0 = none, play at the requested rate). Version 1
+// archives have no display times and read the same way.
+//
+// Every plane is stored either run-length encoded or as a delta against the
+// same plane of the previous frame (skip/copy runs of changed cells); the
+// writer keeps whichever is smaller. Keyframes are RLE-only, so seeking
+// decodes at most one keyframe interval. All integers are little-endian.
+
+constexpr uint32_t kArchiveColors = 1u;  // header flag: color planes present
+
+class AsciiArchiveWriter {
+public:
+    ~AsciiArchiveWriter();
+
+    /**
+     * Create an archive; frames are appended with append() and the index is
+     * written by close().
+     * @param keyInterval force an RLE keyframe every N frames
+     */
+    bool open(const std::string& path, int width, int height, bool withColors, int keyInterval = 30);
+
+    bool append(const std::vector<AsciiPixel>& frame, int delayMs = 0);
+    bool close();
+
+    [[nodiscard]] int frameCount() const { return static_cast<int>(index.size()); }
+    [[nodiscard]] uint64_t bytesWritten() const { return offset; }
+
+private:
+    struct IndexEntry {
+        uint64_t offset;
+        uint32_t size;
+        uint32_t flags;
+    };
+
+    bool write(const void* bytes, size_t n);
+
+    FILE* file = nullptr;
+    int width = 0;
+    int height = 0;
+    bool colors = false;
+    int keyInterval = 30;
+    uint64_t offset = 0;
+    std::vector<IndexEntry> index;
+    std::vector<AsciiPixel> previous;
+    std::vector<unsigned char> scratch;       // reused frame encode buffer
+    std::vector<unsigned char> planeScratch;  // reused per-plane candidate buffer
+};
+
+// Random-access reader over a memory-mapped archive. Memory use is one
+// decoded grid regardless of archive length.
+class AsciiArchiveReader {
+public:
+    bool open(const std::string& path);
+
+    [[nodiscard]] int frameCount() const { return frames; }
+    [[nodiscard]] int width() const { return gridWidth; }
+    [[nodiscard]] int height() const { return gridHeight; }
+    [[nodiscard]] bool hasColors() const { return colors; }
+
+    /**
+     * Decode frame `index` into out. Sequential access decodes one frame;
+     * a seek replays from the preceding keyframe.
+     */
+    bool frame(int index, std::vector<AsciiPixel>& out);
+
+    // Display time of frame `index` in milliseconds (0 when not stored)
+    [[nodiscard]] int frameDelayMs(int index) const;
+
+private:
+    bool decodeInto(int index, std::vector<AsciiPixel>& grid) const;
+
+    std::shared_ptr<MappedFile> file;
+    const unsigned char* indexTable = nullptr;
+    int gridWidth = 0;
+    int gridHeight = 0;
+    int frames = 0;
+    bool colors = false;
+    int decodedIndex = -1;               // frame currently held in `current`
+    std::vector<AsciiPixel> current;
+};
+
+// -------------------- end ASCII ARCHIVE --------------------
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "image_converter.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// -------------------- EXPORTERS --------------------
+// HTML and SVG writers for converted ASCII grids. Neighbouring cells with the
+// same color (after optional quantization) are merged into one <span>/<tspan>,
+// and spaces join whatever run they sit in since their color is invisible.
+// Output goes through one reusable buffer that is flushed in large chunks.
+
+enum class ExportFormat {
+    Ansi,  // terminal output via printAsciiArt
+    Html,
+    Svg,
+};
+
+struct ExportOptions {
+    ExportFormat format = ExportFormat::Html;
+    bool useColors = true;
+    int quantizeBits = 0;  // low bits dropped per channel before comparing colors (0-7)
+};
+
+// Parse "ansi", "html" or "svg"
+bool parseExportFormat(const std::string& name, ExportFormat& format);
+
+/**
+ * Write the grid as an HTML <pre> block or a standalone SVG document.
+ * @return Number of bytes written (0 on error or for ExportFormat::Ansi)
+ */
+size_t exportAscii(
+    const std::vector<AsciiPixel>& ascii,
+    int width,
+    int height,
+    const ExportOptions& options,
+    FILE* out
+);
+
+// -------------------- end EXPORTERS --------------------
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "image_loader.h"
+#include <string>
+#include <vector>
+
+// ============================================================================
+// AUTO-TUNING
+// ============================================================================
+
+// One measured configuration: stage ("sobel" or "hsv") at a given scaled
+// frame size, with one backend and worker count.
+struct TuneEntry {
+    std::string stage;
+    int pixels;     // scaled frame size (width * height)
+    bool useAsm;
+    int threads;
+    double ms;      // median over the tuning repetitions
+};
+
+// Backend/thread choice for one stage
+struct TuneChoice {
+    bool useAsm = false;
+    int threads = 0;
+    double ms = 0.0;
+};
+
+struct TuneProfile {
+    std::vector<TuneEntry> entries;
+
+    // Plain text, one "stage pixels backend threads ms" entry per line
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // Fastest configuration for the stage at the measured size closest to
+    // pixels (log-scale distance). Returns false if the stage was not tuned.
+    bool pick(const std::string& stage, int pixels, TuneChoice& choice) const;
+};
+
+// Default profile location (current directory)
+inline constexpr const char* kDefaultTuneProfile = "img_to_ascii.tune";
+
+// Microbenchmark every stage backend over a grid of output sizes and thread
+// counts, using sample (the decoded input) as the image content.
+TuneProfile runTuning(const Image& sample, int repetitions = 5);
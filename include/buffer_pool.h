@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// -------------------- BUFFER POOL --------------------
+// Size-bucketed pool of 64-byte aligned pixel buffers. Buckets are powers of
+// two, so repeated conversions of same-sized frames get their previous buffers
+// back instead of going through the allocator.
+
+class ImageBufferPool {
+public:
+    static constexpr size_t kAlignment = 64;
+
+    // Process-wide pool used by Image::allocate
+    static ImageBufferPool& instance();
+
+    // Buffer of at least bytes (rounded up to the bucket size), 64-byte aligned
+    void* acquire(size_t bytes);
+
+    // Return a buffer obtained from acquire() with the same requested size
+    void release(void* buffer, size_t bytes);
+
+    // Free every idle buffer
+    void trim();
+
+    // Upper bound on idle bytes kept for reuse (default 256 MB)
+    void setRetainLimit(size_t bytes);
+
+    [[nodiscard]] size_t hits() const;
+    [[nodiscard]] size_t misses() const;
+
+    ~ImageBufferPool();
+
+private:
+    ImageBufferPool() = default;
+    static size_t bucketSize(size_t bytes);
+
+    mutable std::mutex mutex;
+    std::unordered_map<size_t, std::vector<void*>> idle;  // bucket size -> free buffers
+    size_t idleBytes = 0;
+    size_t retainLimit = 256u * 1024u * 1024u;
+    size_t hitCount = 0;
+    size_t missCount = 0;
+};
+
+// -------------------- end BUFFER POOL --------------------
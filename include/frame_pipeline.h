@@ -0,0 +1,50 @@
+#pragma once
+
+#include "image_converter.h"
+#include <functional>
+#include <vector>
+
+// -------------------- FRAME PIPELINE --------------------
+// Converts an ordered frame sequence with whole frames in flight on a pool of
+// workers. The source is read on its own thread (GIF frames are composited
+// onto the previous one, so decoding is serial), every worker converts whole
+// frames on its own thread (resolveThreadCount() is 1 there), and converted
+// grids reach the sink on the calling thread in sequence order. At most
+// `window` frames are read but not yet delivered, so memory stays bounded
+// however long the sequence is.
+
+struct PipelineFrame {
+    int index = 0;
+    int delayMs = 0;          // display time reported by the source
+    int width = 0;
+    int height = 0;
+    double convertMs = 0.0;   // worker time spent converting this frame
+    // Stage statistics the converter reads back on its worker (the g_last*
+    // globals are per thread, so the sink cannot read them itself)
+    double edgeSkipRatio = 0.0;
+    double hsvMs = 0.0;
+    std::vector<AsciiPixel> ascii;
+};
+
+// Next frame and its display time; false at the end of the sequence or on error
+using FrameSource = std::function<bool(Image& frame, int& delayMs)>;
+// Fill ascii, width and height of out from one frame; false on error
+using FrameConverter = std::function<bool(const Image& frame, PipelineFrame& out)>;
+// Receives the frames in order; false stops the pipeline
+using FrameSink = std::function<bool(const PipelineFrame& frame)>;
+
+struct PipelineStats {
+    int frames = 0;        // frames delivered to the sink
+    int peakInFlight = 0;  // most frames read but not yet delivered at once
+};
+
+/**
+ * Run source -> converter -> sink until the source ends
+ * @param workers converter threads (0 = resolveThreadCount())
+ * @param window frames allowed in flight (0 = twice the workers)
+ * @return false when a conversion failed or the sink stopped the pipeline
+ */
+bool runFramePipeline(const FrameSource& source, const FrameConverter& convert, const FrameSink& sink,
+                      int workers, int window, PipelineStats& stats);
+
+// -------------------- end FRAME PIPELINE --------------------
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// GLYPH BITMASKS (STRUCTURE-AWARE GLYPH MATCHING)
+// ============================================================================
+
+// A cell is sampled as a kGlyphCols x kGlyphRows block; bit (y * kGlyphCols + x)
+// of a mask is set where the block is brighter than its mean (glyph ink).
+inline constexpr int kGlyphCols = 4;
+inline constexpr int kGlyphRows = 8;
+
+// 4x8 bitmaps of the ASCII glyphs with a recognizable shape, row-major from
+// the top, '#' = ink. Only shape matters: cells without visible structure keep
+// their density glyph.
+struct GlyphBitmap {
+    char character;
+    const char* rows;
+};
+
+// kGlyphBitmaps is generated at build time (tools/gen_glyph_masks.cpp) by
+// reducing the font-rendered glyph sheet tools/glyph_sheet.txt to 4x8 cells
+#include "glyph_bitmaps.h"
+
+inline constexpr size_t kGlyphCount = std::size(kGlyphBitmaps);
+
+struct GlyphMask {
+    uint32_t bits;
+    int ink;  // popcount(bits), for pruning: |ink(a) - ink(b)| <= hamming(a, b)
+    char character;
+};
+
+// Pack the bitmaps at compile time, ordered by ink so a search can be limited
+// to the glyphs whose ink is close to the cell's (stable: ties keep table order)
+consteval std::array<GlyphMask, kGlyphCount> buildGlyphMasks() {
+    std::array<GlyphMask, kGlyphCount> masks{};
+    for (size_t g = 0; g < kGlyphCount; ++g) {
+        uint32_t bits = 0;
+        for (int i = 0; i < kGlyphCols * kGlyphRows; ++i) {
+            if (kGlyphBitmaps[g].rows[i] == '#') bits |= uint32_t{1} << i;
+        }
+        GlyphMask mask{bits, std::popcount(bits), kGlyphBitmaps[g].character};
+        size_t pos = g;
+        for (; pos > 0 && masks[pos - 1].ink > mask.ink; --pos) masks[pos] = masks[pos - 1];
+        masks[pos] = mask;
+    }
+    return masks;
+}
+
+inline constexpr std::array<GlyphMask, kGlyphCount> kGlyphMasks = buildGlyphMasks();
+
+// kGlyphMasks[kGlyphInkStart[n]] is the first glyph with at least n ink bits
+consteval std::array<uint8_t, kGlyphCols * kGlyphRows + 2> buildGlyphInkStart() {
+    std::array<uint8_t, kGlyphCols * kGlyphRows + 2> start{};
+    size_t g = 0;
+    for (int n = 0; n < static_cast<int>(start.size()); ++n) {
+        while (g < kGlyphCount && kGlyphMasks[g].ink < n) ++g;
+        start[n] = static_cast<uint8_t>(g);
+    }
+    return start;
+}
+
+inline constexpr auto kGlyphInkStart = buildGlyphInkStart();
+
+// Every bitmap must be exactly kGlyphCols x kGlyphRows
+consteval bool glyphBitmapsWellFormed() {
+    for (const GlyphBitmap& glyph : kGlyphBitmaps) {
+        int n = 0;
+        while (glyph.rows[n] != '\0') {
+            if (glyph.rows[n] != '#' && glyph.rows[n] != '.') return false;
+            ++n;
+        }
+        if (n != kGlyphCols * kGlyphRows) return false;
+    }
+    return true;
+}
+static_assert(glyphBitmapsWellFormed(), "glyph bitmaps must be 4x8 strings of '#' and '.'");
@@ -3,12 +3,32 @@
 #include "image_loader.h"
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
+#include <ostream>
 #include <vector>
 
 // Global flags to control use of assembly for specific modules (defined in main.cpp)
 extern bool g_sobelAsm; // when true, use ASM implementation for Sobel
 extern bool g_hsvAsm;   // when true, use ASM implementation for HSV batch
+extern bool g_brailleAsm; // when true, use ASM implementation for braille dot packing
+extern bool g_sobelFlatSkip; // when true, Sobel skips tiles too flat to hold an edge
+extern bool g_grayFastPath;  // when true, colorless pipelines decode a single luma plane
+
+// Channels the pipelines decode to: one luma plane when nothing downstream
+// needs color (colors and HSV off), RGB otherwise
+inline int pipelineChannels(bool useColors, bool useHsv) {
+    return g_grayFastPath && !useColors && !useHsv ? 1 : 3;
+}
+
+// Edge detector used by the conversion pipelines (defined in main.cpp)
+enum class EdgeMode {
+    Sobel,  // normalized Sobel magnitude thresholded at kEdgeThreshold
+    Canny,  // Sobel + non-maximum suppression + hysteresis
+};
+extern EdgeMode g_edgeMode;
+extern float g_cannyLow;   // hysteresis thresholds on the normalized magnitude
+extern float g_cannyHigh;
 
 // ============================================================================
 // HSV CONVERSION STRUCTURES AND HELPERS
@@ -52,6 +72,41 @@ inline PixelHSV rgbToHsvCpp(float r, float g, float b) {
     return hsv;
 }
 
+// Hue class drawn as '#' in HSV mode (defined in main.cpp): saturation above
+// saturationMin and hue within [hueMin, hueMax] degrees, wrapping through 0
+// when hueMin > hueMax. The default picks out blues.
+struct HueRule {
+    float hueMin = 180.0f;
+    float hueMax = 260.0f;
+    float saturationMin = 0.15f;
+
+    [[nodiscard]] bool matches(float h, float s) const {
+        if (s <= saturationMin) return false;
+        return hueMin <= hueMax ? (h >= hueMin && h <= hueMax) : (h >= hueMin || h <= hueMax);
+    }
+};
+extern HueRule g_hueRule;
+extern bool g_hsvLut;  // when true, HSV mode reads levels and hue classes from lookup tables
+
+// HSV mode without the HSV pass. V is max(r, g, b), so its ramp position is
+// exact from the largest byte; hue classes come from RGB quantized to 5-6-5
+// bits and only differ from per-pixel HSV near the rule's boundaries.
+inline constexpr size_t kHsvLutSize = size_t{1} << 16;
+inline constexpr uint8_t kHueClassRule = 0x01;
+
+struct HsvLut {
+    std::array<float, 256> ramp;                 // density ramp position of V, by max(r, g, b)
+    std::array<uint8_t, kHsvLutSize> hueClass;   // kHueClassRule where g_hueRule matches
+};
+
+inline unsigned rgb565Index(unsigned char r, unsigned char g, unsigned char b) {
+    return (static_cast<unsigned>(r >> 3) << 11) | (static_cast<unsigned>(g >> 2) << 5) | (b >> 3);
+}
+
+// The tables for g_hueRule, built on first use (rule flags must be parsed by
+// then) and shared by every thread for the rest of the process
+const HsvLut& hsvLut();
+
 // ============================================================================
 // SOBEL EDGE DETECTION
 // ============================================================================
@@ -62,6 +117,9 @@ struct EdgeInfo {
     float angle;      // [0, 360) in degrees, direction of edge
 };
 
+// Normalized magnitude above which a pixel is drawn with an edge glyph
+inline constexpr float kEdgeThreshold = 0.25f;
+
 // Sobel kernel directions
 // 0 = horizontal edge, 90 = vertical edge
 struct SobelResult {
@@ -102,6 +160,19 @@ struct AsciiCharMap {
 // Accounts for terminal character aspect ratio (typically 1:2)
 Image scaleImage(const Image& src, int targetWidth, int targetHeight, float aspectRatio = 0.5f);
 
+// Interpolate one destination row from two adjacent source rows (row0 above row1).
+// fy is the vertical fraction between them. Shared by scaleImage and the
+// streaming scaler so both paths produce identical pixels.
+void scaleRowBilinear(
+    const unsigned char* row0,
+    const unsigned char* row1,
+    int srcWidth,
+    int channels,
+    float fy,
+    unsigned char* dstRow,
+    int targetWidth
+);
+
 // ============================================================================
 // THREADED SOBEL EDGE DETECTION
 // ============================================================================
@@ -165,8 +236,68 @@ struct EdgeMap {
 
 // Detect edges using Sobel operator with threading
 // blockSize: number of pixels per thread block (larger = fewer threads)
+// With g_sobelFlatSkip, tiles whose luma range cannot reach kEdgeThreshold
+// are left at zero; the glyphs produced by convertToAscii do not change.
 EdgeMap detectEdgesSobel(const Image& img, int blockSize = 64);
 
+// Canny on top of the Sobel gradients: non-maximum suppression along the
+// getEdgeChar direction bins, then hysteresis (weak >= low, strong >= high,
+// 8-connected) through a parallel lock-free union-find. Kept pixels have
+// magnitude 1, everything else 0; angles are the Sobel angles.
+EdgeMap detectEdgesCanny(const Image& img, float lowThreshold, float highThreshold);
+
+// Sobel or Canny depending on g_edgeMode
+EdgeMap detectEdges(const Image& img);
+
+// Unnormalized Sobel over the inner pixels of [x0, x1) x [y0, y1), written
+// into an existing map of the image's size. Uses the same kernels as
+// detectEdgesSobel (the ASM backend always processes whole rows), so each
+// magnitude equals detectEdgesSobel's before normalization.
+// Returns the largest magnitude written.
+float sobelRegion(const Image& img, EdgeMap& edges, int x0, int y0, int x1, int y1);
+
+// Whether Sobel on this image runs the ASM kernel, which reads three-byte
+// pixels; single-plane (grayscale) images take the C++ kernel
+inline bool sobelUsesAsm(const Image& img) {
+    return g_sobelAsm && img.channels == 3;
+}
+
+// ============================================================================
+// LEVELS (AUTO-CONTRAST / EQUALIZATION)
+// ============================================================================
+
+// Luma -> glyph mapping used by convertToAscii (defined in main.cpp)
+enum class LevelsMode {
+    Off,       // fixed pow(l, 0.8) curve
+    Auto,      // stretch the 0.5%..99.5% luma percentiles to full range, then the same curve
+    Equalize,  // histogram equalization
+};
+extern LevelsMode g_levelsMode;
+
+// Glyph level (index into densityChars) for each 8-bit luma bin
+using LevelsLut = std::array<unsigned char, 256>;
+
+// Build the image's 256-bin luma histogram (per-thread private histograms
+// merged at the end) and derive the glyph table for the mode.
+// Returns false for LevelsMode::Off or an invalid image.
+bool buildLevelsLut(const Image& img, LevelsMode mode, LevelsLut& lut);
+
+// Error diffusion over the glyph ramp (defined in main.cpp). Applies to the
+// brightness level only; hue and edge overrides are drawn on top.
+enum class DitherMode {
+    None,            // truncate to the ramp level
+    FloydSteinberg,  // 7/3/5/1 over two rows
+    Atkinson,        // 6 x 1/8 over three rows, 2/8 dropped
+};
+extern DitherMode g_ditherMode;
+
+// How cell glyphs are chosen (defined in main.cpp)
+enum class GlyphMode {
+    Density,    // brightness ramp only
+    Structure,  // contrasted cells take the glyph whose 4x8 shape matches best
+};
+extern GlyphMode g_glyphMode;
+
 // ============================================================================
 // ASCII CONVERSION
 // ============================================================================
@@ -177,7 +308,12 @@ struct AsciiPixel {
 };
 
 // Convert processed image to ASCII art
-// Uses brightness for character density and edge info for special characters
+// Uses brightness for character density and edge info for special characters.
+// With g_levelsMode set, brightness goes through the image's levels table
+// (luma only: HSV mode never builds one).
+// With g_ditherMode set, the quantization error of each cell is diffused to
+// its neighbours; rows run as a wavefront, each a few columns behind the one
+// above, and the result does not depend on the thread count.
 std::vector<AsciiPixel> convertToAscii(
     const Image& scaledImg,
     const EdgeMap* edges = nullptr,
@@ -185,6 +321,52 @@ std::vector<AsciiPixel> convertToAscii(
     bool useHsv = false
 );
 
+// Same, writing into a caller-owned grid of width*height cells. Rows are
+// split across worker threads (g_threadCount) on large grids; reusing the
+// grid between frames avoids any per-frame allocation of the output.
+void convertToAscii(
+    const Image& scaledImg,
+    const EdgeMap* edges,
+    bool useEdges,
+    bool useHsv,
+    AsciiPixel* out
+);
+
+// Re-convert only cells [x0, x1) x [y0, y1) of an existing full-size grid.
+// Produces exactly the cells convertToAscii would for the same inputs, given
+// the levels table of the whole frame (null = default curve). Dithering is
+// not local, so the region is always drawn undithered.
+void convertToAsciiRegion(
+    const Image& scaledImg,
+    const EdgeMap* edges,
+    bool useEdges,
+    bool useHsv,
+    int x0,
+    int y0,
+    int x1,
+    int y1,
+    std::vector<AsciiPixel>& ascii,
+    const LevelsLut* levels = nullptr
+);
+
+// Replace the glyphs of a cols x rows grid by shape: source is point-sampled
+// at 4x8 pixels per cell, each cell is thresholded at its mean into a 32-bit
+// mask and drawn with the glyph of glyph_masks.h at the smallest Hamming
+// distance. Cells whose luma range is too small to show a shape, or that no
+// glyph fits closely, keep the glyph already in out; every cell keeps its
+// color. Matches are cached per worker thread; rows are split across workers
+// (g_threadCount).
+void matchGlyphStructure(const Image& source, int cols, int rows, AsciiPixel* out);
+
+// Write ASCII art (ANSI colors optional) to any stream
+void writeAsciiArt(
+    std::ostream& out,
+    const std::vector<AsciiPixel>& ascii,
+    int width,
+    int height,
+    bool useColors = false
+);
+
 // Print ASCII art to console with optional colors
 void printAsciiArt(
     const std::vector<AsciiPixel>& ascii,
@@ -193,6 +375,38 @@ void printAsciiArt(
     bool useColors = false
 );
 
+// ============================================================================
+// BRAILLE RENDERING
+// ============================================================================
+
+// One terminal cell of a braille rendering: 2x4 dots, bit i = dot i+1 of the
+// U+2800 block (left column 0x01 0x02 0x04 0x40, right column 0x08 0x10 0x20 0x80)
+struct BrailleCell {
+    unsigned char dots;
+    unsigned char r, g, b;  // mean color of the cell's 8 pixels
+};
+
+// Convert an image into a (width/2) x (height/4) braille grid, one dot per
+// pixel (scale it to 2x4 pixels per cell first). A dot is lit where the
+// pixel's luma is above the image's mean luma or, with edges, where the edge
+// magnitude is above kEdgeThreshold.
+// Dots are packed by the ASM kernel when g_brailleAsm is set; rows are split
+// across worker threads (g_threadCount).
+std::vector<BrailleCell> convertToBraille(
+    const Image& scaledImg,
+    const EdgeMap* edges = nullptr
+);
+
+// Write a braille grid as UTF-8 (ANSI colors optional). Rows are formatted
+// in parallel into per-row buffers, then written in order.
+void writeBrailleArt(
+    std::ostream& out,
+    const std::vector<BrailleCell>& cells,
+    int width,
+    int height,
+    bool useColors = false
+);
+
 // ============================================================================
 // ASSEMBLY FUNCTIONS (ARM64)
 // ============================================================================
@@ -209,29 +423,60 @@ extern "C" {
     // imageData: pointer to image buffer (RGB, 3 bytes per pixel)
     // width, height: image dimensions
     // startY, endY: region of rows [startY, endY) to compute (interior rows only)
-    // stride: bytes per pixel (channels)
+    // stride: bytes between the starts of consecutive rows (Image::stride)
     // outputGx, outputGy: output arrays for gradients
     void sobelGradients(
         const unsigned char* imageData,
         int width,
         int height,
-        int stride,  // bytes per pixel (channels)
+        int stride,  // row stride in bytes
         int startY,
         int endY,
         float* outputGx,
         float* outputGy,
-        float* lumaBuffer // optional preallocated luminance buffer (can be null)
+        float* lumaBuffer // width*height floats of scratch owned by the caller (null = no-op)
+    );
+
+    // Pack braille cells from a 4-row strip of 8-bit levels
+    // levels: row 0 of the strip; rows are rowStride bytes apart, 2*cols bytes each
+    // threshold: a dot is lit where its level is > threshold (unsigned)
+    // out: cols dot bytes (U+2800 bit layout)
+    void brailleDots(
+        const unsigned char* levels,
+        int rowStride,
+        int cols,
+        int threshold,
+        unsigned char* out
     );
 }
 
 // Global thread count (0 = auto/hardware_concurrency), clamped to [1,64]
 extern int g_threadCount;
 
-// Temporary luminance buffer used by ASM Sobel implementation.
-// Allocated in C++ and filled/read by assembly when `g_sobelAsm` is enabled.
-extern float* g_lumaBuffer;
+// Set on the workers of the frame pipeline, which convert whole frames in
+// parallel: the stages of one frame stay on the worker's own thread
+extern thread_local bool g_frameWorker;
+
+// Resolve g_threadCount to the actual number of workers to use (1 on a frame worker)
+int resolveThreadCount();
+
+// Sobel stage thread count chosen by --auto for the actual frame size
+// (0 = follow g_threadCount). Other stages keep resolving g_threadCount.
+extern int g_sobelThreadCount;
+
+// Resolve the Sobel stage's workers: g_sobelThreadCount when set, otherwise
+// resolveThreadCount() (1 on a frame worker either way)
+int resolveSobelThreadCount();
+
+// Last measured HSV conversion time (milliseconds) set by convertToAscii.
+// This and the two ratios below are per thread: they describe the last image
+// converted on the calling thread.
+extern thread_local double g_lastHsvMs;
+
+// Share of inner pixels skipped as flat by the last detectEdgesSobel call
+extern thread_local double g_lastSobelSkipRatio;
 
-// Last measured HSV conversion time (milliseconds) set by convertToAscii
-extern double g_lastHsvMs;
+// Share of cells the last matchGlyphStructure call redrew by shape
+extern thread_local double g_lastStructureRatio;
 
 
@@ -3,14 +3,30 @@
 
 #include <string>
 #include <array>
+#include <memory>
+
+// Who owns Image::data and how it is released
+enum class ImageStorage {
+    Stb,       // stbi_load or malloc, released with stbi_image_free
+    NewArray,  // new unsigned char[], released with delete[]
+    Pooled,    // ImageBufferPool buffer (64-byte aligned), returned to the pool
+    Aligned,   // 64-byte aligned with rows padded to 64 bytes, released with free
+    Borrowed,  // read-only external memory (e.g. a PROT_READ mmap) kept alive by Image::backing
+};
 
 struct Image {
     unsigned char* data;
     int width;
     int height;
     int channels;
+    int stride;            // bytes per row, >= width * channels
+    ImageStorage storage;
+
+    // Keeps borrowed pixel memory alive (e.g. an mmap'd file). When set, data
+    // points into it and the destructor does not free data.
+    std::shared_ptr<const void> backing;
 
-    Image() : data(nullptr), width(0), height(0), channels(0) {}
+    Image() : data(nullptr), width(0), height(0), channels(0), stride(0), storage(ImageStorage::Stb) {}
     ~Image();
 
     // Disable copying
@@ -21,7 +37,39 @@ struct Image {
     Image(Image&& other) noexcept;
     Image& operator=(Image&& other) noexcept;
 
+    /**
+     * Alokuje niezainicjalizowany bufor obrazu
+     * @param width Szerokość
+     * @param height Wysokość
+     * @param channels Liczba kanałów
+     * @param storage Pooled (domyślnie), NewArray, Stb lub Aligned (wiersze wyrównane do 64 B)
+     * @return Obraz z przydzielonym buforem (niepoprawny przy braku pamięci)
+     */
+    static Image allocate(int width, int height, int channels, ImageStorage storage = ImageStorage::Pooled);
+
+    /**
+     * Tworzy widok na cudzej pamięci tylko do odczytu (Borrowed). Danych
+     * widoku nie wolno modyfikować: np. mapowanie PROT_READ zakończy zapis błędem.
+     * @param data Pierwszy piksel
+     * @param width Szerokość
+     * @param height Wysokość
+     * @param channels Liczba kanałów
+     * @param stride Bajty na wiersz
+     * @param backing Właściciel pamięci, utrzymywany przy życiu przez widok
+     * @return Obraz wskazujący na data
+     */
+    static Image borrow(const unsigned char* data, int width, int height, int channels, int stride,
+                        std::shared_ptr<const void> backing);
+
     [[nodiscard]] bool isValid() const { return data != nullptr && width > 0 && height > 0; }
+    [[nodiscard]] bool isBorrowed() const { return storage == ImageStorage::Borrowed; }
+    [[nodiscard]] bool isPacked() const { return stride == width * channels; }
+
+    [[nodiscard]] unsigned char* row(int y) { return data + static_cast<size_t>(y) * stride; }
+    [[nodiscard]] const unsigned char* row(int y) const { return data + static_cast<size_t>(y) * stride; }
+
+private:
+    void release();
 };
 
 class ImageLoader {
@@ -29,11 +77,25 @@ public:
     /**
      * Ładuje obraz z podanej ścieżki
      * @param filepath Ścieżka do pliku obrazu
-     * @param desiredChannels Liczba kanałów (0 = auto, 3 = RGB, 4 = RGBA)
+     * @param desiredChannels Liczba kanałów (0 = auto, 1 = luma, 3 = RGB, 4 = RGBA).
+     *        Luma z kolorowego źródła powstaje z pełnego bufora RGB, więc szczyt
+     *        pamięci dekodowania to nadal rozmiar RGB; źródła szare dekodowane są od razu do luma.
      * @return Struktura Image z danymi obrazu
      */
     static Image loadImage(const std::string& filepath, int desiredChannels = 0);
 
+    /**
+     * Wczytuje miniaturę osadzoną w pliku JPEG (EXIF IFD1, JFXX albo JFIF),
+     * o ile wystarcza dla docelowego rozmiaru: ma co najmniej minWidth x minHeight
+     * pikseli i proporcje głównego obrazu. Spośród pasujących wybierana jest najmniejsza.
+     * @param filepath Ścieżka do pliku obrazu
+     * @param minWidth Minimalna szerokość miniatury
+     * @param minHeight Minimalna wysokość miniatury
+     * @param desiredChannels Liczba kanałów (jak w loadImage)
+     * @return Miniatura albo niepoprawny Image, gdy potrzebne jest pełne dekodowanie
+     */
+    static Image loadThumbnail(const std::string& filepath, int minWidth, int minHeight, int desiredChannels = 0);
+
     /**
      * Sprawdza czy plik istnieje
      * @param filepath Ścieżka do pliku
@@ -42,6 +104,49 @@ public:
     static bool fileExists(const std::string& filepath);
 };
 
+// Frame-by-frame GIF decoder. Each frame is composited onto the previous ones
+// (so decoding is serial), but only the frames the disposal rules refer back
+// to are kept: memory does not grow with the length of the animation.
+class GifReader {
+public:
+    GifReader();
+    ~GifReader();
+
+    GifReader(const GifReader&) = delete;
+    GifReader& operator=(const GifReader&) = delete;
+
+    /**
+     * Sprawdza czy plik zaczyna się sygnaturą GIF
+     * @param filepath Ścieżka do pliku
+     * @return true dla plików GIF87a/GIF89a
+     */
+    static bool isGif(const std::string& filepath);
+
+    /**
+     * Mapuje plik GIF i przygotowuje dekodowanie pierwszej klatki
+     * @param filepath Ścieżka do pliku .gif
+     * @return true jeśli plik jest poprawnym GIF-em
+     */
+    bool open(const std::string& filepath);
+
+    /**
+     * Dekoduje następną klatkę animacji
+     * @param frame Wyjściowy obraz klatki (pełny rozmiar, po złożeniu z poprzednimi)
+     * @param delayMs Czas wyświetlania klatki w ms; wartości poniżej 20 ms
+     *                (także brak opóźnienia) zamieniane są na 100 ms, jak w przeglądarkach
+     * @param desiredChannels 1 = luma (lumaByte), 3 = RGB, 0/4 = RGBA
+     * @return false po ostatniej klatce albo przy błędzie (patrz failed())
+     */
+    bool next(Image& frame, int& delayMs, int desiredChannels);
+
+    [[nodiscard]] bool failed() const;
+    [[nodiscard]] int framesDecoded() const;
+
+private:
+    struct State;
+    std::unique_ptr<State> state;
+};
+
 // -------------------- PIXEL HELPERS --------------------
 // Lightweight helpers for reading pixels from Image buffers.
 
@@ -64,15 +169,15 @@ inline bool inBounds(const Image& img, int x, int y) {
 }
 
 // Compute base index for pixel (x,y)
-inline int pixelBaseIndex(const Image& img, int x, int y) {
-    return (y * img.width + x) * img.channels;
+inline size_t pixelBaseIndex(const Image& img, int x, int y) {
+    return static_cast<size_t>(y) * img.stride + static_cast<size_t>(x) * img.channels;
 }
 
 // Safe RGB getter (assumes at least 3 channels). If out of bounds or channels < 3, returns zeros.
 inline PixelRGB getPixelRGB(const Image& img, int x, int y) {
     PixelRGB p{0,0,0};
     if (!img.isValid() || !inBounds(img, x, y) || img.channels < 3) return p;
-    int idx = pixelBaseIndex(img, x, y);
+    size_t idx = pixelBaseIndex(img, x, y);
     p.r = img.data[idx + 0];
     p.g = img.data[idx + 1];
     p.b = img.data[idx + 2];
@@ -83,7 +188,7 @@ inline PixelRGB getPixelRGB(const Image& img, int x, int y) {
 inline PixelRGBA getPixelRGBA(const Image& img, int x, int y) {
     PixelRGBA p{0,0,0,255};
     if (!img.isValid() || !inBounds(img, x, y) || img.channels < 1) return p;
-    int idx = pixelBaseIndex(img, x, y);
+    size_t idx = pixelBaseIndex(img, x, y);
     p.r = img.data[idx + 0];
     if (img.channels >= 2) p.g = img.data[idx + 1];
     if (img.channels >= 3) p.b = img.data[idx + 2];
@@ -95,7 +200,7 @@ inline PixelRGBA getPixelRGBA(const Image& img, int x, int y) {
 inline std::array<float,3> getPixelRGBf(const Image& img, int x, int y) {
     std::array<float,3> out{0.f,0.f,0.f};
     if (!img.isValid() || !inBounds(img, x, y) || img.channels < 3) return out;
-    int idx = pixelBaseIndex(img, x, y);
+    size_t idx = pixelBaseIndex(img, x, y);
     out[0] = img.data[idx + 0] / 255.0f;
     out[1] = img.data[idx + 1] / 255.0f;
     out[2] = img.data[idx + 2] / 255.0f;
@@ -103,12 +208,23 @@ inline std::array<float,3> getPixelRGBf(const Image& img, int x, int y) {
 }
 
 // Compute luminance (perceptual) from RGB bytes -> float [0,1]
-// Using Rec. 709 / ITU-R BT.709 weights
+// Using Rec. 709 / ITU-R BT.709 weights. A single-channel image already holds
+// luma (converted by the loader), which is returned as is.
 inline float getLuminance(const Image& img, int x, int y) {
+    if (img.isValid() && img.channels == 1 && inBounds(img, x, y)) {
+        return img.data[pixelBaseIndex(img, x, y)] / 255.0f;
+    }
     auto f = getPixelRGBf(img, x, y);
     return 0.2126f * f[0] + 0.7152f * f[1] + 0.0722f * f[2];
 }
 
+// 8-bit luma with getLuminance's BT.709 weights in 16.16 fixed point (they
+// sum to exactly 65536, so gray stays gray), rounded to nearest. Loaders use
+// it for single-channel output so the gray pipeline sees the RGB pipeline's luma.
+inline unsigned char lumaByte(unsigned char r, unsigned char g, unsigned char b) {
+    return static_cast<unsigned char>((13933u * r + 46871u * g + 4732u * b + 32768u) >> 16);
+}
+
 // Compute index-safe total bytes
 inline size_t imageByteSize(const Image& img) {
     if (!img.isValid()) return 0;
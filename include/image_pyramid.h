@@ -0,0 +1,31 @@
+#pragma once
+
+#include "image_loader.h"
+#include <vector>
+
+// ============================================================================
+// IMAGE PYRAMID
+// ============================================================================
+
+// Halve an image with a 2x2 box filter. Rows are split across worker threads
+// (g_threadCount). Odd trailing rows/columns are folded into the last output
+// pixel so no source data is dropped.
+Image downsample2x(const Image& src);
+
+// Successive 2x box-filtered reductions of one decoded image.
+// levels[0] is the full-resolution image, each next level is half the size.
+struct ImagePyramid {
+    std::vector<Image> levels;
+
+    // Smallest level that is still at least targetWidth x targetHeight,
+    // i.e. the cheapest level to bilinear-scale from without upsampling.
+    [[nodiscard]] const Image& levelFor(int targetWidth, int targetHeight) const;
+
+    // Index of the level returned by levelFor
+    [[nodiscard]] int levelIndexFor(int targetWidth, int targetHeight) const;
+};
+
+// Build a pyramid on top of base, stopping once the next level would be
+// smaller than minWidth x minHeight (the smallest requested output size), so
+// every output has a level less than twice its size to scale from.
+ImagePyramid buildPyramid(Image&& base, int minWidth, int minHeight);
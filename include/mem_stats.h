@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+
+// -------------------- MEMORY ACCOUNTING --------------------
+// Opt-in (--mem-stats) heap accounting per pipeline stage. operator new and
+// delete are replaced process-wide and always go straight to malloc/free;
+// while g_memStats is set they also count. Pixel buffers that bypass operator
+// new (stb_image's decoder, Image and ImageBufferPool storage) use the
+// tracked* wrappers below. Resident set size and its high-water mark are read
+// from /proc/self/status when a stage ends.
+
+extern bool g_memStats;  // defined in main.cpp; set before any worker thread starts
+
+// Stages of the single-image pipeline; everything else (setup, sequences,
+// multi-size) is accounted to Other
+enum class MemStage {
+    Other,
+    Load,
+    Scale,
+    Edges,
+    Ascii,
+    Render,
+    Count,
+};
+
+// malloc family with accounting (plain calls when g_memStats is off)
+void* trackedMalloc(size_t bytes);
+void* trackedAlignedAlloc(size_t alignment, size_t bytes);
+void* trackedRealloc(void* buffer, size_t bytes);
+void trackedFree(void* buffer);
+
+// Close the current stage (sampling RSS) and account allocations to `stage` from now on
+void memStatsStage(MemStage stage);
+
+// Emit METRIC:Mem_* lines for every stage that ran; no-op when g_memStats is off
+void printMemStats();
+
+// -------------------- end MEMORY ACCOUNTING --------------------
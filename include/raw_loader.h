@@ -0,0 +1,96 @@
+#pragma once
+
+#include "image_loader.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// -------------------- RAW FRAME LOADERS --------------------
+// Uncompressed formats (binary PPM/PGM/PAM, YUV4MPEG2) are memory-mapped and
+// returned as Image views over the mapping when the stored layout already
+// matches the requested channel count, so no decode and no copy happens.
+
+// Read-only mapping of a whole file. Image views hold it via Image::backing,
+// so the mapping lives as long as the last view.
+class MappedFile {
+public:
+    static std::shared_ptr<MappedFile> open(const std::string& filepath);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] const unsigned char* data() const { return base; }
+    [[nodiscard]] size_t size() const { return length; }
+
+private:
+    MappedFile(const unsigned char* base, size_t length) : base(base), length(length) {}
+
+    const unsigned char* base;
+    size_t length;
+};
+
+// Frame access for a mapped YUV4MPEG2 stream (4:2:0, 4:2:2, 4:4:4, mono)
+class Y4mReader {
+public:
+    /**
+     * Mapuje plik Y4M i indeksuje ramki
+     * @param filepath Ścieżka do pliku .y4m
+     * @return true jeśli nagłówek i ramki są poprawne
+     */
+    bool open(const std::string& filepath);
+
+    /**
+     * Indeksuje ramki już zmapowanego pliku Y4M (bez ponownego mapowania)
+     * @param mapped Mapowanie pliku
+     * @return true jeśli nagłówek i ramki są poprawne
+     */
+    bool open(std::shared_ptr<MappedFile> mapped);
+
+    [[nodiscard]] int frameCount() const { return static_cast<int>(frameOffsets.size()); }
+    [[nodiscard]] int width() const { return frameWidth; }
+    [[nodiscard]] int height() const { return frameHeight; }
+
+    /**
+     * Zwraca ramkę jako obraz
+     * @param index Numer ramki
+     * @param desiredChannels 0 = natywnie (widok płaszczyzny Y bez kopiowania dla monochromatycznych),
+     *                        1 = luma (lumaByte po konwersji do RGB), 3/4 = konwersja do RGB(A)
+     * @return Struktura Image (niepoprawna przy błędzie)
+     */
+    [[nodiscard]] Image frame(int index, int desiredChannels) const;
+
+private:
+    std::shared_ptr<MappedFile> file;
+    std::vector<size_t> frameOffsets;  // offset of the Y plane of each frame
+    int frameWidth = 0;
+    int frameHeight = 0;
+    int chromaShiftX = 1;  // log2 of horizontal chroma subsampling
+    int chromaShiftY = 1;  // log2 of vertical chroma subsampling
+    bool monochrome = false;
+};
+
+class RawLoader {
+public:
+    /**
+     * Sprawdza czy plik jest obsługiwanym nieskompresowanym formatem (PPM/PGM/PAM/Y4M)
+     * @param filepath Ścieżka do pliku
+     * @return true jeśli plik można wczytać przez mmap
+     */
+    static bool isRawFormat(const std::string& filepath);
+
+    /**
+     * Wczytuje nieskompresowany obraz przez mmap. Gdy układ pikseli w pliku
+     * odpowiada żądanej liczbie kanałów, zwracany jest widok bez kopiowania.
+     * Przy żądaniu 1 kanału kolorowy raster PNM/PAM także zwracany jest jako
+     * widok (3/4 kanały): konwersja do lumy czytałaby cały plik z góry.
+     * Dla Y4M zwracana jest pierwsza ramka.
+     * @param filepath Ścieżka do pliku
+     * @param desiredChannels Liczba kanałów (0 = jak w pliku)
+     * @return Struktura Image z danymi obrazu
+     */
+    static Image loadImage(const std::string& filepath, int desiredChannels = 0);
+};
+
+// -------------------- end RAW FRAME LOADERS --------------------
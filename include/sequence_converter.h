@@ -0,0 +1,66 @@
+#pragma once
+
+#include "image_converter.h"
+#include <vector>
+
+// ============================================================================
+// TEMPORAL FRAME REUSE
+// ============================================================================
+
+// Converts consecutive frames of a sequence, recomputing only what changed.
+// The scaled frame is compared with the previous one tile by tile (including a
+// one-pixel halo, which is everything a tile's Sobel and glyphs depend on);
+// only dirty tiles go through Sobel and the glyph pass, the cached EdgeMap and
+// AsciiPixel grid are reused everywhere else. Raw gradient magnitudes are
+// cached so that when the frame's maximum changes, every glyph is re-derived
+// from the new normalization. The result always equals convertFrame's.
+// Canny edges are not tile-local (hysteresis), so with EdgeMode::Canny any
+// change recomputes the edges and glyphs of the whole frame. Likewise, a
+// change in the frame's levels table (g_levelsMode) redraws every glyph, and
+// with dithering (g_ditherMode) any change redraws the whole frame.
+class SequenceConverter {
+public:
+    SequenceConverter(int targetWidth, int adjustedHeight, bool useEdges, bool useHsv);
+
+    /**
+     * Convert the next frame of the sequence
+     * @return The frame's grid (empty on error); valid until the next call
+     */
+    const std::vector<AsciiPixel>& convert(const Image& frame);
+
+    [[nodiscard]] int width() const { return gridWidth; }
+    [[nodiscard]] int height() const { return gridHeight; }
+
+    // Share of tiles recomputed over all frames after the first (1 when there were none)
+    [[nodiscard]] double dirtyRatio() const {
+        return comparedTiles > 0 ? static_cast<double>(dirtyTiles) / comparedTiles : 1.0;
+    }
+
+private:
+    struct Tile {
+        int x0, y0, x1, y1;
+        float maxGradient;
+    };
+
+    void reset(int w, int h);
+    bool tileChanged(const Image& scaled, const Tile& tile) const;
+    void normalize(const Tile& tile);
+
+    int targetWidth;
+    int adjustedHeight;
+    bool useEdges;
+    bool useHsv;
+
+    int gridWidth = 0;
+    int gridHeight = 0;
+    Image previous;               // last scaled frame
+    EdgeMap gradients{0, 0};      // raw magnitudes and angles
+    EdgeMap edges{0, 0};          // normalized view passed to the glyph pass
+    float maxGradient = 0.0f;
+    LevelsLut levels{};           // last frame's table when g_levelsMode is on
+    std::vector<Tile> tiles;
+    std::vector<AsciiPixel> ascii;
+
+    size_t dirtyTiles = 0;
+    size_t comparedTiles = 0;
+};
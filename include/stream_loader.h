@@ -0,0 +1,116 @@
+#pragma once
+
+#include "image_loader.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// -------------------- STREAMING INGEST --------------------
+// Row-by-row decode path for very large inputs. Source rows are pushed
+// top-to-bottom into a StreamingScaler, which keeps only the two rows needed
+// for bilinear interpolation, so peak memory depends on the output size and
+// not on the input size.
+
+// Header of a binary PNM file (P5 = PGM, P6 = PPM, P7 = PAM)
+struct PnmHeader {
+    int width = 0;
+    int height = 0;
+    int channels = 0;       // 1 for P5, 3 for P6, PAM DEPTH (1, 3 or 4) for P7
+    int maxValue = 0;       // only 255 is supported
+    size_t dataOffset = 0;  // byte offset of the first pixel
+};
+
+/**
+ * Parsuje nagłówek binarnego pliku PNM (P5/P6/P7) z bufora
+ * @param data Początek pliku
+ * @param size Liczba dostępnych bajtów
+ * @param header Wynik parsowania
+ * @return true jeśli nagłówek jest poprawny i obsługiwany
+ */
+bool parsePnmHeader(const unsigned char* data, size_t size, PnmHeader& header);
+
+// Convert one row of 1/3/4-channel pixels (RGB or BGR order) to 1, 3 or 4
+// channels. Gray output is lumaByte (BT.709, as getLuminance).
+void convertPixelRow(
+    const unsigned char* src,
+    int srcChannels,
+    bool bgr,
+    unsigned char* dst,
+    int dstChannels,
+    int width
+);
+
+// Incremental bilinear downscaler. Produces exactly the same pixels as
+// scaleImage() for the same source and target size.
+class StreamingScaler {
+public:
+    StreamingScaler(int srcWidth, int srcHeight, int channels, int targetWidth, int targetHeight);
+
+    // Feed the next source row (srcWidth * channels bytes, rows in order)
+    void pushRow(const unsigned char* row);
+
+    // Number of source rows consumed so far
+    [[nodiscard]] int rowsConsumed() const { return rowsPushed; }
+
+    // Bytes held by the scaler (output image + row buffers)
+    [[nodiscard]] size_t memoryFootprint() const;
+
+    // Release the finished output. Rows never reached stay black.
+    Image finish();
+
+private:
+    void emitReadyRows();
+
+    int srcWidth;
+    int srcHeight;
+    int channels;
+    int targetWidth;
+    int targetHeight;
+    float scaleY;
+    int rowsPushed = 0;
+    int nextOutputRow = 0;
+    std::vector<unsigned char> prevRow;
+    std::vector<unsigned char> curRow;
+    Image dst;
+};
+
+class StreamingLoader {
+public:
+    /**
+     * Sprawdza czy format pliku pozwala na dekodowanie wierszami (PPM/PGM/PAM, BMP)
+     * @param filepath Ścieżka do pliku obrazu
+     * @return true jeśli plik można przetwarzać strumieniowo
+     */
+    static bool canStream(const std::string& filepath);
+
+    /**
+     * Wczytuje obraz i od razu skaluje go do docelowego rozmiaru.
+     * Formaty strumieniowe są dekodowane wierszami; pozostałe (JPEG, PNG, ...)
+     * są dekodowane w całości tylko wtedy, gdy mieszczą się w limicie pamięci.
+     * @param filepath Ścieżka do pliku obrazu
+     * @param targetWidth Docelowa szerokość
+     * @param targetHeight Docelowa wysokość
+     * @param desiredChannels Liczba kanałów wyjściowych (1 lub 3)
+     * @param memoryCapBytes Limit pamięci szczytowej (0 = bez limitu)
+     * @param peakBytes Opcjonalnie: szacowana pamięć szczytowa ścieżki
+     * @return Przeskalowany obraz (niepoprawny w razie błędu, także dla uciętego pliku)
+     */
+    static Image loadScaled(
+        const std::string& filepath,
+        int targetWidth,
+        int targetHeight,
+        int desiredChannels,
+        size_t memoryCapBytes = 0,
+        size_t* peakBytes = nullptr
+    );
+
+    /**
+     * Szacuje pamięć potrzebną na pełne zdekodowanie obrazu
+     * @param filepath Ścieżka do pliku obrazu
+     * @param desiredChannels Liczba kanałów po dekodowaniu
+     * @return Liczba bajtów (0 jeśli nie można odczytać nagłówka)
+     */
+    static size_t estimateDecodeBytes(const std::string& filepath, int desiredChannels);
+};
+
+// -------------------- end STREAMING INGEST --------------------
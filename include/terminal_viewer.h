@@ -0,0 +1,24 @@
+#pragma once
+
+#include "image_loader.h"
+#include <cstddef>
+
+// ============================================================================
+// INTERACTIVE TERMINAL VIEWER
+// ============================================================================
+
+struct ViewerOptions {
+    bool useEdges = true;
+    bool useHsv = false;
+    bool useColors = false;
+    int tileCols = 32;          // glyph tile width in terminal cells
+    int tileRows = 16;          // glyph tile height in terminal cells
+    size_t maxCachedTiles = 1024;
+};
+
+// Run the pan/zoom viewer on an already decoded image until the user quits.
+// Keys: arrows/hjkl pan, PgUp/PgDn or HJKL pan by a screen, +/- zoom,
+// 0 reset, q/Esc/Ctrl+C quit. The terminal is restored on exit (also on SIGTERM
+// and SIGHUP) and re-laid out on SIGWINCH.
+// Returns the process exit code.
+int runViewer(Image&& image, const ViewerOptions& options);
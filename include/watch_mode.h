@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ascii_export.h"
+#include <string>
+
+// ============================================================================
+// DIRECTORY WATCH MODE
+// ============================================================================
+
+struct WatchOptions {
+    std::string directory;        // spool directory to watch
+    std::string outputDirectory;  // empty = write next to the input
+    int targetWidth = 120;
+    int adjustedHeight = 45;
+    bool useEdges = true;
+    bool useHsv = false;
+    bool useColors = false;
+    bool thumbnails = true;       // serve small targets from embedded JPEG thumbnails
+    ExportOptions exportOptions;  // Ansi appends .txt, Html/Svg append .html/.svg (a.jpg -> a.jpg.txt)
+    int workers = 0;              // converter threads (0 = half the hardware threads)
+    int fileLimit = 0;            // stop after this many files (0 = run until SIGINT/SIGTERM)
+};
+
+// Watch a directory with inotify (IN_CLOSE_WRITE / IN_MOVED_TO) and convert
+// every file that lands there on a pool of long-lived workers, one file per
+// worker thread (the stages of a file run single-threaded). Outputs are
+// written to a temporary name and renamed, so readers never see partial files.
+// Per-file latency is measured from the inotify event to the rename.
+// Linux only (inotify); on other platforms it reports an error and returns 1.
+// Returns the process exit code.
+int runWatch(const WatchOptions& options);
@@ -89,6 +89,11 @@ for name in "noasm_edges_colors" "noasm_edges_colors_hsv" "asm_none" "asm_sobel_
   echo "Average Edge_ms: $avg_edge ms" >> "$SUMMARY"
   echo "Average HSV_ms: $avg_hsv ms" >> "$SUMMARY"
   echo "Average Total_ms: $avg_total ms" >> "$SUMMARY"
+  # One extra run with allocation accounting, kept out of the timed runs
+  mem_out=$($BIN $IMG $flags --mem-stats 2>&1 || true)
+  echo "Peak RSS: $(extract_metric "$mem_out" "Mem_peak_rss_kb") kB" >> "$SUMMARY"
+  echo "Heap peak: $(extract_metric "$mem_out" "Mem_heap_peak_bytes") bytes" >> "$SUMMARY"
+  echo "Allocations: $(extract_metric "$mem_out" "Mem_allocs") ($(extract_metric "$mem_out" "Mem_alloc_bytes") bytes)" >> "$SUMMARY"
   echo >> "$SUMMARY"
 done
 
@@ -0,0 +1,205 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Golden-output and timing regression check.
+#
+# Renders every imgs/*.jpg|png through each backend and thread count, dumps the
+# AsciiPixel grid (--dump) and compares it with img_to_ascii --diff:
+#   - against the stored golden grid of the same combination (exact),
+#   - against the single-threaded C++ grid of the same mode (GLYPH_TOL/COLOR_TOL).
+# Median stage timings are compared with the stored baseline; a stage slower
+# than baseline * (1 + MARGIN) fails the run. TIMING=0 skips the timing check.
+#
+#   ./scripts/regression_check.sh                    # grids and timings
+#   ctest --test-dir build                           # grids only (REPS=1 TIMING=0)
+#   ctest --test-dir build -L timing                 # timings (-DREGRESSION_TIMING=ON)
+#
+# The golden grids (regression/golden) are committed for the C++ and the ASM
+# backends; the ASM backends run on ARM64 hosts (ASM=1/0 forces them on/off).
+# Re-record the grids after a change that intentionally alters the output:
+#
+#   cmake --build build && ./scripts/regression_check.sh --record
+#
+# and commit regression/ together with the change. The timing baseline only
+# holds for the machine it was recorded on; record one for yours with
+#
+#   ./scripts/regression_check.sh --record-baseline  # BASELINE=... for another file
+
+BIN=${BIN:-build/img_to_ascii}
+GOLDEN_DIR=${GOLDEN_DIR:-regression/golden}
+BASELINE=${BASELINE:-regression/baseline.txt}
+THREADS=${THREADS:-"1 2 4 8"}
+REPS=${REPS:-5}
+MARGIN=${MARGIN:-0.25}
+GLYPH_TOL=${GLYPH_TOL:-0.02}
+# The ASM Sobel kernel weights luma BT.601 and the C++ one BT.709, so its edges
+# (and the glyphs they pick) differ slightly more from the C++ reference
+ASM_SOBEL_GLYPH_TOL=${ASM_SOBEL_GLYPH_TOL:-0.03}
+COLOR_TOL=${COLOR_TOL:-0}
+TIMING=${TIMING:-1}
+ASM=${ASM:-auto}
+
+# --record: golden grids and timing baseline; --record-baseline: timings only
+RECORD=0
+RECORD_GRIDS=0
+case "${1:-}" in
+  --record) RECORD=1; RECORD_GRIDS=1 ;;
+  --record-baseline) RECORD=1 ;;
+esac
+
+if [ ! -x "$BIN" ]; then
+  echo "Binary $BIN not found or not executable. Build first." >&2
+  exit 1
+fi
+
+# backend => flags; reference => the single-threaded C++ backend producing the same output
+declare -A backends reference tolerance
+backends[cpp]="--no-hsv --no-sobel-asm --no-hsv-asm"
+backends[cpp_hsv]="--hsv --no-sobel-asm --no-hsv-asm"
+reference[cpp]=cpp
+reference[cpp_hsv]=cpp_hsv
+names="cpp cpp_hsv"
+
+# The ASM backends only exist on ARM64 builds (ASM=1 forces them, ASM=0 skips them)
+if [ "$ASM" = "auto" ]; then
+  case "$(uname -m)" in
+    aarch64|arm64) ASM=1 ;;
+    *) ASM=0 ;;
+  esac
+fi
+case "$ASM" in
+  1)
+    backends[asm_sobel]="--no-hsv --sobel-asm --no-hsv-asm"
+    backends[asm_hsv]="--hsv --no-sobel-asm --hsv-asm"
+    backends[asm_both]="--hsv --sobel-asm --hsv-asm"
+    reference[asm_sobel]=cpp
+    reference[asm_hsv]=cpp_hsv
+    reference[asm_both]=cpp_hsv
+    tolerance[asm_sobel]=$ASM_SOBEL_GLYPH_TOL
+    tolerance[asm_both]=$ASM_SOBEL_GLYPH_TOL
+    names="$names asm_sobel asm_hsv asm_both"
+    ;;
+esac
+
+COMMON="--edges --colors --no-render"
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+mkdir -p "$GOLDEN_DIR" "$(dirname "$BASELINE")"
+if [ "$RECORD" -eq 1 ]; then
+  : > "$BASELINE"
+fi
+
+extract_metric() {
+  printf "%s" "$1" | sed -n "s/^METRIC:$2:\(.*\)$/\1/p" | tail -n1
+}
+
+median() {
+  tr ' ' '\n' | grep -v '^$' | sort -g | awk '{v[NR]=$1} END{if(NR==0) print "nan"; else print v[int((NR+1)/2)]}'
+}
+
+failures=0
+checks=0
+skipped=0
+goldens=0
+timed=0
+
+fail() {
+  echo "  FAIL: $*"
+  failures=$((failures+1))
+}
+
+for img in imgs/*.jpg imgs/*.png; do
+  [ -f "$img" ] || continue
+  base=$(basename "${img%.*}")
+  echo "Image: $img"
+
+  for name in $names; do
+    for t in $THREADS; do
+      key="${base}_${name}_t${t}"
+      grid="$WORK/$key.a2a"
+      ref="$WORK/${base}_${reference[$name]}_t1.a2a"
+      edges=""
+      totals=""
+
+      for i in $(seq 1 "$REPS"); do
+        out=$($BIN "$img" $COMMON ${backends[$name]} --threads "$t" --dump "$grid" 2>&1) || {
+          fail "$key: run failed"
+          continue 2
+        }
+        edges="$edges $(extract_metric "$out" "EdgeDetection_ms")"
+        totals="$totals $(extract_metric "$out" "TOTAL_ms")"
+      done
+      edge_ms=$(printf "%s" "$edges" | median)
+      total_ms=$(printf "%s" "$totals" | median)
+      printf "  %-28s edge=%8s ms  total=%8s ms\n" "$key" "$edge_ms" "$total_ms"
+
+      if [ "$RECORD" -eq 1 ]; then
+        if [ "$RECORD_GRIDS" -eq 1 ]; then
+          cp "$grid" "$GOLDEN_DIR/$key.a2a"
+        fi
+        echo "$key $edge_ms $total_ms" >> "$BASELINE"
+        continue
+      fi
+
+      # 1) Golden grid of the same combination
+      if [ ! -f "$GOLDEN_DIR/$key.a2a" ]; then
+        echo "  SKIP: $key: no golden grid (run with --record)"
+        skipped=$((skipped+1))
+      else
+        checks=$((checks+1))
+        goldens=$((goldens+1))
+        if ! $BIN "$grid" --diff "$GOLDEN_DIR/$key.a2a" > "$WORK/diff.txt" 2>&1; then
+          fail "$key vs golden: $(grep -E 'FAIL|ERROR' "$WORK/diff.txt" | head -n1)"
+        fi
+      fi
+
+      # 2) Cross-backend / cross-thread agreement with single-threaded C++
+      if [ "$grid" != "$ref" ] && [ -f "$ref" ]; then
+        checks=$((checks+1))
+        if ! $BIN "$grid" --diff "$ref" --tolerance "${tolerance[$name]:-$GLYPH_TOL}" --color-tolerance "$COLOR_TOL" \
+             > "$WORK/diff.txt" 2>&1; then
+          fail "$key vs ${reference[$name]}_t1: $(grep -E 'FAIL|ERROR' "$WORK/diff.txt" | head -n1)"
+        fi
+      fi
+
+      # 3) Timing against the recorded baseline
+      line=""
+      if [ "$TIMING" -ne 0 ]; then
+        line=$(grep "^$key " "$BASELINE" 2>/dev/null || true)
+      fi
+      if [ -n "$line" ]; then
+        checks=$((checks+1))
+        timed=$((timed+1))
+        base_edge=$(echo "$line" | awk '{print $2}')
+        base_total=$(echo "$line" | awk '{print $3}')
+        for stage in "edge $edge_ms $base_edge" "total $total_ms $base_total"; do
+          set -- $stage
+          if awk -v cur="$2" -v ref="$3" -v m="$MARGIN" \
+               'BEGIN{exit !(cur != "nan" && ref != "nan" && ref > 0 && cur > ref * (1 + m))}'; then
+            fail "$key: $1 ${2} ms exceeds baseline ${3} ms by more than ${MARGIN}"
+          fi
+        done
+      fi
+    done
+  done
+done
+
+if [ "$RECORD" -eq 1 ]; then
+  if [ "$RECORD_GRIDS" -eq 1 ]; then
+    echo "Recorded golden grids in $GOLDEN_DIR and timings in $BASELINE"
+  else
+    echo "Recorded timings in $BASELINE"
+  fi
+  exit 0
+fi
+
+if [ "$goldens" -eq 0 ]; then
+  fail "no golden grids in $GOLDEN_DIR (run with --record)"
+fi
+if [ "$TIMING" -ne 0 ] && [ "$timed" -eq 0 ]; then
+  fail "no timings for these runs in $BASELINE (run with --record-baseline)"
+fi
+
+echo "Checks: $checks, skipped: $skipped, failures: $failures"
+[ "$failures" -eq 0 ]
@@ -0,0 +1,40 @@
+#!/usr/bin/env python3
+# Render the glyph sheet used for --glyphs structure (tools/glyph_sheet.txt).
+#
+# Each glyph is drawn from a monospaced TrueType font into one character cell,
+# cropped vertically to the ascender-descender extent of '|', and box-filtered
+# to 16x32 coverage samples (hex digit 0-f per sample). The build reduces the
+# sheet to the 4x8 bitmasks (tools/gen_glyph_masks.cpp); only re-run this when
+# the glyph set or the font changes.
+#
+# Usage: scripts/render_glyph_sheet.py [font.ttf] [output]
+# Requires Pillow.
+import sys
+
+from PIL import Image, ImageDraw, ImageFont
+
+FONT = sys.argv[1] if len(sys.argv) > 1 else "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf"
+OUTPUT = sys.argv[2] if len(sys.argv) > 2 else "tools/glyph_sheet.txt"
+
+# ASCII glyphs with a recognizable shape; cells without visible structure keep
+# their density glyph, so letters that are mostly blobs are left out
+GLYPHS = "|-_=/\\()[]<>^v'`.,:~+xXTLJ7YUHOonurbdpq#@"
+
+SHEET_W, SHEET_H = 16, 32  # coverage samples per glyph
+RENDER_SIZE = 104          # px per em; rendered large, then box-filtered
+
+font = ImageFont.truetype(FONT, RENDER_SIZE)
+advance = round(font.getlength("M"))
+_, top, _, bottom = font.getbbox("|")
+
+with open(OUTPUT, "w") as out:
+    out.write("# Glyph sheet for --glyphs structure, generated by scripts/render_glyph_sheet.py\n")
+    out.write(f"# from {FONT.rsplit('/', 1)[-1]} (Bitstream Vera / DejaVu font license).\n")
+    out.write(f"# {SHEET_W}x{SHEET_H} coverage samples per glyph, 0 = blank, f = full ink.\n")
+    for ch in GLYPHS:
+        cell = Image.new("L", (advance, bottom - top), 0)
+        ImageDraw.Draw(cell).text((0, -top), ch, font=font, fill=255)
+        pixels = cell.resize((SHEET_W, SHEET_H), Image.BOX).load()
+        out.write(f"glyph {ch}\n")
+        for y in range(SHEET_H):
+            out.write("".join("%x" % round(pixels[x, y] * 15 / 255) for x in range(SHEET_W)) + "\n")
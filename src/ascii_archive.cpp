@@ -0,0 +1,335 @@
+#include "../include/ascii_archive.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+static_assert(sizeof(AsciiPixel) == 4, "archive planes assume a packed 4-byte AsciiPixel");
+
+namespace {
+
+constexpr char kMagic[4] = {'A', '2', 'A', '1'};
+constexpr uint32_t kVersion = 2;
+constexpr uint32_t kOldestVersion = 1;  // no display times
+constexpr uint32_t kIndexKeyframe = 1u;
+constexpr int kIndexDelayShift = 8;
+constexpr uint32_t kMaxDelayMs = 0xFFFFFF;
+constexpr size_t kHeaderBytes = 32;
+constexpr size_t kIndexEntryBytes = 16;
+
+enum PlaneMode : unsigned char {
+    PlaneRle = 0,    // (varint run, element) pairs
+    PlaneDelta = 1,  // (varint skip, varint copy, copy x element) against the previous frame
+};
+
+// Glyph plane = AsciiPixel::character, color plane = r,g,b
+struct Plane {
+    size_t offset;
+    size_t elemSize;
+};
+constexpr Plane kGlyphPlane{0, 1};
+constexpr Plane kColorPlane{1, 3};
+
+inline const unsigned char* element(const AsciiPixel* grid, size_t i, const Plane& plane) {
+    return reinterpret_cast<const unsigned char*>(grid + i) + plane.offset;
+}
+
+inline bool sameElement(const AsciiPixel* a, const AsciiPixel* b, size_t i, const Plane& plane) {
+    return std::memcmp(element(a, i, plane), element(b, i, plane), plane.elemSize) == 0;
+}
+
+void putU32(std::vector<unsigned char>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<unsigned char>(v >> (8 * i)));
+}
+
+void putU64(std::vector<unsigned char>& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<unsigned char>(v >> (8 * i)));
+}
+
+uint32_t getU32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+         | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t getU64(const unsigned char* p) {
+    return static_cast<uint64_t>(getU32(p)) | (static_cast<uint64_t>(getU32(p + 4)) << 32);
+}
+
+void putVarint(std::vector<unsigned char>& out, size_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<unsigned char>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(v));
+}
+
+bool getVarint(const unsigned char*& p, const unsigned char* end, size_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        unsigned char byte = *p++;
+        v |= static_cast<size_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+void encodeRle(const AsciiPixel* grid, size_t count, const Plane& plane, std::vector<unsigned char>& out) {
+    size_t i = 0;
+    while (i < count) {
+        size_t run = 1;
+        while (i + run < count && sameElement(grid, grid + run, i, plane)) ++run;
+        putVarint(out, run);
+        const unsigned char* e = element(grid, i, plane);
+        out.insert(out.end(), e, e + plane.elemSize);
+        i += run;
+    }
+}
+
+void encodeDelta(const AsciiPixel* grid, const AsciiPixel* prev, size_t count, const Plane& plane,
+                 std::vector<unsigned char>& out) {
+    size_t i = 0;
+    while (i < count) {
+        size_t skip = 0;
+        while (i + skip < count && sameElement(grid, prev, i + skip, plane)) ++skip;
+        i += skip;
+        size_t copy = 0;
+        while (i + copy < count && !sameElement(grid, prev, i + copy, plane)) ++copy;
+        putVarint(out, skip);
+        putVarint(out, copy);
+        for (size_t k = 0; k < copy; ++k) {
+            const unsigned char* e = element(grid, i + k, plane);
+            out.insert(out.end(), e, e + plane.elemSize);
+        }
+        i += copy;
+    }
+}
+
+// Append one plane record: mode byte, payload length, payload
+void encodePlane(const AsciiPixel* grid, const AsciiPixel* prev, size_t count, const Plane& plane,
+                 std::vector<unsigned char>& out, std::vector<unsigned char>& tmp) {
+    tmp.clear();
+    encodeRle(grid, count, plane, tmp);
+    unsigned char mode = PlaneRle;
+
+    if (prev != nullptr) {
+        size_t rleBytes = tmp.size();
+        size_t mark = tmp.size();
+        encodeDelta(grid, prev, count, plane, tmp);
+        if (tmp.size() - mark < rleBytes) {
+            tmp.erase(tmp.begin(), tmp.begin() + static_cast<std::ptrdiff_t>(mark));
+            mode = PlaneDelta;
+        } else {
+            tmp.resize(mark);
+        }
+    }
+
+    out.push_back(mode);
+    putU32(out, static_cast<uint32_t>(tmp.size()));
+    out.insert(out.end(), tmp.begin(), tmp.end());
+}
+
+// Decode one plane record into grid (which holds the previous frame for delta planes)
+bool decodePlane(const unsigned char*& p, const unsigned char* end, AsciiPixel* grid, size_t count,
+                 const Plane& plane) {
+    if (end - p < 5) return false;
+    unsigned char mode = p[0];
+    size_t length = getU32(p + 1);
+    p += 5;
+    if (static_cast<size_t>(end - p) < length) return false;
+    const unsigned char* q = p;
+    const unsigned char* planeEnd = p + length;
+    p = planeEnd;
+
+    size_t i = 0;
+    while (i < count) {
+        if (mode == PlaneRle) {
+            size_t run;
+            if (!getVarint(q, planeEnd, run) || run == 0 || run > count - i
+                || static_cast<size_t>(planeEnd - q) < plane.elemSize) return false;
+            for (size_t k = 0; k < run; ++k) {
+                std::memcpy(reinterpret_cast<unsigned char*>(grid + i + k) + plane.offset, q, plane.elemSize);
+            }
+            q += plane.elemSize;
+            i += run;
+        } else if (mode == PlaneDelta) {
+            size_t skip, copy;
+            if (!getVarint(q, planeEnd, skip) || !getVarint(q, planeEnd, copy)) return false;
+            if (skip > count - i || copy > count - i - skip
+                || static_cast<size_t>(planeEnd - q) < copy * plane.elemSize) return false;
+            i += skip;
+            for (size_t k = 0; k < copy; ++k) {
+                std::memcpy(reinterpret_cast<unsigned char*>(grid + i + k) + plane.offset, q, plane.elemSize);
+                q += plane.elemSize;
+            }
+            i += copy;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// ============================================================================
+// WRITER
+// ============================================================================
+
+AsciiArchiveWriter::~AsciiArchiveWriter() {
+    if (file != nullptr) close();
+}
+
+bool AsciiArchiveWriter::write(const void* bytes, size_t n) {
+    if (std::fwrite(bytes, 1, n, file) != n) return false;
+    offset += n;
+    return true;
+}
+
+bool AsciiArchiveWriter::open(const std::string& path, int w, int h, bool withColors, int interval) {
+    if (w <= 0 || h <= 0) return false;
+
+    file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        std::cerr << "[ERROR] Cannot create archive: " << path << std::endl;
+        return false;
+    }
+
+    width = w;
+    height = h;
+    colors = withColors;
+    keyInterval = interval > 0 ? interval : 1;
+    offset = 0;
+    index.clear();
+    previous.clear();
+
+    // Placeholder header; frame count and index offset are patched by close()
+    unsigned char header[kHeaderBytes] = {};
+    return write(header, sizeof(header));
+}
+
+bool AsciiArchiveWriter::append(const std::vector<AsciiPixel>& frame, int delayMs) {
+    const size_t count = static_cast<size_t>(width) * height;
+    if (file == nullptr || frame.size() != count) return false;
+
+    bool keyframe = previous.empty() || index.size() % keyInterval == 0;
+    const AsciiPixel* prev = keyframe ? nullptr : previous.data();
+
+    scratch.clear();
+    encodePlane(frame.data(), prev, count, kGlyphPlane, scratch, planeScratch);
+    if (colors) {
+        encodePlane(frame.data(), prev, count, kColorPlane, scratch, planeScratch);
+    }
+
+    uint32_t delay = std::min<uint32_t>(static_cast<uint32_t>(std::max(0, delayMs)), kMaxDelayMs);
+    index.push_back({offset, static_cast<uint32_t>(scratch.size()),
+                     (keyframe ? kIndexKeyframe : 0u) | (delay << kIndexDelayShift)});
+    previous = frame;
+    return write(scratch.data(), scratch.size());
+}
+
+bool AsciiArchiveWriter::close() {
+    if (file == nullptr) return false;
+
+    std::vector<unsigned char> bytes;
+    bytes.reserve(index.size() * kIndexEntryBytes);
+    for (const IndexEntry& e : index) {
+        putU64(bytes, e.offset);
+        putU32(bytes, e.size);
+        putU32(bytes, e.flags);
+    }
+    uint64_t indexOffset = offset;
+    bool ok = write(bytes.data(), bytes.size());
+
+    bytes.clear();
+    bytes.insert(bytes.end(), kMagic, kMagic + 4);
+    putU32(bytes, kVersion);
+    putU32(bytes, static_cast<uint32_t>(width));
+    putU32(bytes, static_cast<uint32_t>(height));
+    putU32(bytes, static_cast<uint32_t>(index.size()));
+    putU32(bytes, colors ? kArchiveColors : 0u);
+    putU64(bytes, indexOffset);
+    ok = ok && std::fseek(file, 0, SEEK_SET) == 0
+            && std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
+
+// ============================================================================
+// READER
+// ============================================================================
+
+bool AsciiArchiveReader::open(const std::string& path) {
+    file = MappedFile::open(path);
+    if (!file || file->size() < kHeaderBytes || std::memcmp(file->data(), kMagic, 4) != 0) {
+        file.reset();
+        return false;
+    }
+
+    const unsigned char* h = file->data();
+    uint32_t version = getU32(h + 4);
+    if (version < kOldestVersion || version > kVersion) {
+        file.reset();
+        return false;
+    }
+    gridWidth = static_cast<int>(getU32(h + 8));
+    gridHeight = static_cast<int>(getU32(h + 12));
+    frames = static_cast<int>(getU32(h + 16));
+    colors = (getU32(h + 20) & kArchiveColors) != 0;
+    uint64_t indexOffset = getU64(h + 24);
+
+    if (gridWidth <= 0 || gridHeight <= 0 || frames < 0
+        || indexOffset > file->size()
+        || (file->size() - indexOffset) / kIndexEntryBytes < static_cast<uint64_t>(frames)) {
+        file.reset();
+        return false;
+    }
+
+    indexTable = file->data() + indexOffset;
+    decodedIndex = -1;
+    current.assign(static_cast<size_t>(gridWidth) * gridHeight, AsciiPixel{' ', 0, 0, 0});
+    return true;
+}
+
+bool AsciiArchiveReader::decodeInto(int i, std::vector<AsciiPixel>& grid) const {
+    const unsigned char* entry = indexTable + static_cast<size_t>(i) * kIndexEntryBytes;
+    uint64_t frameOffset = getU64(entry);
+    uint32_t frameSize = getU32(entry + 8);
+    if (frameOffset + frameSize > file->size()) return false;
+
+    const unsigned char* p = file->data() + frameOffset;
+    const unsigned char* end = p + frameSize;
+    if (!decodePlane(p, end, grid.data(), grid.size(), kGlyphPlane)) return false;
+    if (colors && !decodePlane(p, end, grid.data(), grid.size(), kColorPlane)) return false;
+    return true;
+}
+
+bool AsciiArchiveReader::frame(int index, std::vector<AsciiPixel>& out) {
+    if (!file || index < 0 || index >= frames) return false;
+
+    if (index != decodedIndex) {
+        int start = index;
+        if (index != decodedIndex + 1) {
+            // Seek: replay from the nearest keyframe at or before index
+            while (start > 0
+                   && (getU32(indexTable + static_cast<size_t>(start) * kIndexEntryBytes + 12) & kIndexKeyframe) == 0) {
+                --start;
+            }
+        }
+        for (int i = start; i <= index; ++i) {
+            if (!decodeInto(i, current)) {
+                decodedIndex = -1;
+                return false;
+            }
+        }
+        decodedIndex = index;
+    }
+
+    out = current;
+    return true;
+}
+
+int AsciiArchiveReader::frameDelayMs(int index) const {
+    if (!file || index < 0 || index >= frames) return 0;
+    return static_cast<int>(getU32(indexTable + static_cast<size_t>(index) * kIndexEntryBytes + 12) >> kIndexDelayShift);
+}
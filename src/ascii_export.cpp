@@ -0,0 +1,198 @@
+#include "../include/ascii_export.h"
+#include <cstring>
+
+namespace {
+
+constexpr size_t kFlushThreshold = 256 * 1024;
+
+class OutputBuffer {
+public:
+    explicit OutputBuffer(FILE* out) : out(out) {
+        buffer().clear();
+    }
+
+    ~OutputBuffer() { flush(); }
+
+    void append(const char* s, size_t n) {
+        std::string& buf = buffer();
+        buf.append(s, n);
+        if (buf.size() >= kFlushThreshold) flush();
+    }
+
+    void append(const char* s) { append(s, std::strlen(s)); }
+    void append(char c) { append(&c, 1); }
+
+    void appendEscaped(char c) {
+        switch (c) {
+            case '&': append("&amp;"); break;
+            case '<': append("&lt;"); break;
+            case '>': append("&gt;"); break;
+            case '"': append("&quot;"); break;
+            default: append(c); break;
+        }
+    }
+
+    void appendColor(const AsciiPixel& p) {
+        static const char hex[] = "0123456789abcdef";
+        char color[7] = {'#',
+                         hex[p.r >> 4], hex[p.r & 15],
+                         hex[p.g >> 4], hex[p.g & 15],
+                         hex[p.b >> 4], hex[p.b & 15]};
+        append(color, sizeof(color));
+    }
+
+    bool flush() {
+        std::string& buf = buffer();
+        if (!buf.empty()) {
+            if (std::fwrite(buf.data(), 1, buf.size(), out) != buf.size()) failed = true;
+            written += buf.size();
+            buf.clear();
+        }
+        return !failed;
+    }
+
+    [[nodiscard]] size_t bytes() const { return written + buffer().size(); }
+
+private:
+    // Reused across calls so repeated exports do not reallocate
+    static std::string& buffer() {
+        thread_local std::string storage = [] {
+            std::string s;
+            s.reserve(kFlushThreshold + 4096);
+            return s;
+        }();
+        return storage;
+    }
+
+    FILE* out;
+    size_t written = 0;
+    bool failed = false;
+};
+
+AsciiPixel quantize(const AsciiPixel& p, int bits) {
+    if (bits <= 0) return p;
+    unsigned char mask = static_cast<unsigned char>(0xff << bits);
+    return {p.character,
+            static_cast<unsigned char>(p.r & mask),
+            static_cast<unsigned char>(p.g & mask),
+            static_cast<unsigned char>(p.b & mask)};
+}
+
+bool sameColor(const AsciiPixel& a, const AsciiPixel& b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+// Emit one row as color runs: open(run color) text... close
+template <typename Open>
+void writeRuns(OutputBuffer& buf, const AsciiPixel* row, int width, const ExportOptions& options,
+               Open open, const char* close) {
+    if (!options.useColors) {
+        for (int x = 0; x < width; ++x) buf.appendEscaped(row[x].character);
+        return;
+    }
+
+    int x = 0;
+    while (x < width) {
+        // Leading spaces need no color
+        while (x < width && row[x].character == ' ') {
+            buf.append(' ');
+            ++x;
+        }
+        if (x >= width) break;
+
+        AsciiPixel color = quantize(row[x], options.quantizeBits);
+        open(color);
+        while (x < width) {
+            const AsciiPixel& p = row[x];
+            if (p.character != ' ' && !sameColor(quantize(p, options.quantizeBits), color)) break;
+            buf.appendEscaped(p.character);
+            ++x;
+        }
+        buf.append(close);
+    }
+}
+
+void writeHtml(OutputBuffer& buf, const std::vector<AsciiPixel>& ascii, int width, int height,
+               const ExportOptions& options) {
+    buf.append("<pre class=\"ascii-art\" style=\"font-family:monospace;line-height:1;"
+               "background:#000;color:#ccc\">\n");
+    auto open = [&buf](const AsciiPixel& c) {
+        buf.append("<span style=\"color:");
+        buf.appendColor(c);
+        buf.append("\">");
+    };
+    for (int y = 0; y < height; ++y) {
+        writeRuns(buf, ascii.data() + static_cast<size_t>(y) * width, width, options, open, "</span>");
+        buf.append('\n');
+    }
+    buf.append("</pre>\n");
+}
+
+void writeSvg(OutputBuffer& buf, const std::vector<AsciiPixel>& ascii, int width, int height,
+              const ExportOptions& options) {
+    // Monospace advance is ~0.6em; one text row per line of cells
+    const int fontSize = 14;
+    const double cellWidth = fontSize * 0.6;
+    char line[256];
+
+    int n = std::snprintf(line, sizeof(line),
+        "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%.0f\" height=\"%d\" "
+        "font-family=\"monospace\" font-size=\"%d\" fill=\"#ccc\">\n"
+        "<rect width=\"100%%\" height=\"100%%\" fill=\"#000\"/>\n",
+        width * cellWidth, height * fontSize, fontSize);
+    buf.append(line, static_cast<size_t>(n));
+
+    auto open = [&buf](const AsciiPixel& c) {
+        buf.append("<tspan fill=\"");
+        buf.appendColor(c);
+        buf.append("\">");
+    };
+    for (int y = 0; y < height; ++y) {
+        n = std::snprintf(line, sizeof(line),
+            "<text x=\"0\" y=\"%d\" xml:space=\"preserve\" textLength=\"%.0f\">",
+            (y + 1) * fontSize, width * cellWidth);
+        buf.append(line, static_cast<size_t>(n));
+        writeRuns(buf, ascii.data() + static_cast<size_t>(y) * width, width, options, open, "</tspan>");
+        buf.append("</text>\n");
+    }
+    buf.append("</svg>\n");
+}
+
+} // namespace
+
+bool parseExportFormat(const std::string& name, ExportFormat& format) {
+    if (name == "ansi") {
+        format = ExportFormat::Ansi;
+    } else if (name == "html") {
+        format = ExportFormat::Html;
+    } else if (name == "svg") {
+        format = ExportFormat::Svg;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+size_t exportAscii(
+    const std::vector<AsciiPixel>& ascii,
+    int width,
+    int height,
+    const ExportOptions& options,
+    FILE* out
+) {
+    if (out == nullptr || options.format == ExportFormat::Ansi || width <= 0 || height <= 0
+        || ascii.size() < static_cast<size_t>(width) * height) {
+        return 0;
+    }
+
+    OutputBuffer buf(out);
+    if (options.format == ExportFormat::Svg) {
+        writeSvg(buf, ascii, width, height, options);
+    } else {
+        writeHtml(buf, ascii, width, height, options);
+    }
+
+    if (!buf.flush()) return 0;
+    std::fflush(out);
+    return buf.bytes();
+}
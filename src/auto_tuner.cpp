@@ -0,0 +1,159 @@
+#include "../include/auto_tuner.h"
+#include "../include/image_converter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+// ============================================================================
+// PROFILE FILE
+// ============================================================================
+
+bool TuneProfile::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.good()) return false;
+
+    entries.clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ls(line);
+        TuneEntry e;
+        std::string backend;
+        if (ls >> e.stage >> e.pixels >> backend >> e.threads >> e.ms) {
+            e.useAsm = (backend == "asm");
+            entries.push_back(e);
+        }
+    }
+    return !entries.empty();
+}
+
+bool TuneProfile::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.good()) return false;
+
+    out << "# img_to_ascii tuning profile (" << std::thread::hardware_concurrency() << " hardware threads)\n";
+    out << "# stage pixels backend threads ms\n";
+    for (const TuneEntry& e : entries) {
+        out << e.stage << ' ' << e.pixels << ' ' << (e.useAsm ? "asm" : "cpp") << ' '
+            << e.threads << ' ' << e.ms << '\n';
+    }
+    return out.good();
+}
+
+bool TuneProfile::pick(const std::string& stage, int pixels, TuneChoice& choice) const {
+    // Closest tuned size first, then the fastest entry at that size
+    int bestSize = -1;
+    double bestDistance = 0.0;
+    for (const TuneEntry& e : entries) {
+        if (e.stage != stage) continue;
+        double distance = std::fabs(std::log(static_cast<double>(std::max(1, e.pixels)))
+                                    - std::log(static_cast<double>(std::max(1, pixels))));
+        if (bestSize < 0 || distance < bestDistance) {
+            bestSize = e.pixels;
+            bestDistance = distance;
+        }
+    }
+    if (bestSize < 0) return false;
+
+    bool found = false;
+    for (const TuneEntry& e : entries) {
+        if (e.stage != stage || e.pixels != bestSize) continue;
+        if (!found || e.ms < choice.ms) {
+            choice.useAsm = e.useAsm;
+            choice.threads = e.threads;
+            choice.ms = e.ms;
+            found = true;
+        }
+    }
+    return found;
+}
+
+// ============================================================================
+// MICROBENCHMARKS
+// ============================================================================
+
+template <typename Fn>
+static double medianMs(int repetitions, Fn&& fn) {
+    repetitions = std::max(1, repetitions);  // the median needs one sample
+    std::vector<double> samples;
+    samples.reserve(repetitions);
+    fn();  // warm-up: page in buffers, spin up threads once
+    for (int i = 0; i < repetitions; ++i) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        samples.push_back(std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(end - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+TuneProfile runTuning(const Image& sample, int repetitions) {
+    TuneProfile profile;
+    if (!sample.isValid()) return profile;
+    repetitions = std::max(1, repetitions);
+
+    // Scaled frame sizes: the usage presets after the 0.75 aspect adjustment,
+    // plus larger exports where threading starts to pay off
+    const std::vector<std::pair<int, int>> sizes = {
+        {80, 22}, {120, 45}, {160, 60}, {200, 75}, {400, 150}, {800, 300}
+    };
+
+    std::vector<int> threadCounts = {1, 2, 4, 8};
+    int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    if (hardware > 0) threadCounts.push_back(hardware);
+    std::sort(threadCounts.begin(), threadCounts.end());
+    threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+    if (hardware > 0) {
+        threadCounts.erase(std::remove_if(threadCounts.begin(), threadCounts.end(),
+                                          [hardware](int t) { return t > hardware; }),
+                           threadCounts.end());
+    }
+
+    const bool savedSobelAsm = g_sobelAsm;
+    const bool savedHsvAsm = g_hsvAsm;
+    const int savedThreads = g_sobelThreadCount;
+
+    for (const auto& [w, h] : sizes) {
+        Image scaled = scaleImage(sample, w, h, 1.0f);
+        if (!scaled.isValid()) continue;
+        const int pixels = w * h;
+
+        for (bool useAsm : {false, true}) {
+            for (int threads : threadCounts) {
+                g_sobelAsm = useAsm;
+                g_sobelThreadCount = threads;
+                double ms = medianMs(repetitions, [&scaled]() {
+                    EdgeMap edges = detectEdgesSobel(scaled);
+                    (void)edges;
+                });
+                profile.entries.push_back({"sobel", pixels, useAsm, threads, ms});
+                std::cout << "  sobel " << w << "x" << h << " " << (useAsm ? "asm" : "cpp")
+                          << " threads=" << threads << ": " << ms << " ms" << std::endl;
+            }
+
+            // HSV batch is single-threaded; time only the conversion itself
+            g_hsvAsm = useAsm;
+            std::vector<double> hsvSamples;
+            convertToAscii(scaled, nullptr, false, true);  // warm-up
+            for (int i = 0; i < repetitions; ++i) {
+                std::vector<AsciiPixel> ascii = convertToAscii(scaled, nullptr, false, true);
+                hsvSamples.push_back(g_lastHsvMs);
+            }
+            std::sort(hsvSamples.begin(), hsvSamples.end());
+            double hsvMs = hsvSamples[hsvSamples.size() / 2];
+            profile.entries.push_back({"hsv", pixels, useAsm, 1, hsvMs});
+            std::cout << "  hsv   " << w << "x" << h << " " << (useAsm ? "asm" : "cpp")
+                      << ": " << hsvMs << " ms" << std::endl;
+        }
+    }
+
+    g_sobelAsm = savedSobelAsm;
+    g_hsvAsm = savedHsvAsm;
+    g_sobelThreadCount = savedThreads;
+    return profile;
+}
@@ -0,0 +1,78 @@
+#include "../include/buffer_pool.h"
+#include "../include/mem_stats.h"
+#include <cstdlib>
+
+ImageBufferPool& ImageBufferPool::instance() {
+    static ImageBufferPool pool;
+    return pool;
+}
+
+size_t ImageBufferPool::bucketSize(size_t bytes) {
+    size_t size = 4096;
+    while (size < bytes) size <<= 1;
+    return size;
+}
+
+void* ImageBufferPool::acquire(size_t bytes) {
+    size_t bucket = bucketSize(bytes);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = idle.find(bucket);
+        if (it != idle.end() && !it->second.empty()) {
+            void* buffer = it->second.back();
+            it->second.pop_back();
+            idleBytes -= bucket;
+            ++hitCount;
+            return buffer;
+        }
+        ++missCount;
+    }
+    // Bucket sizes are multiples of the alignment, as aligned_alloc requires
+    return trackedAlignedAlloc(kAlignment, bucket);
+}
+
+void ImageBufferPool::release(void* buffer, size_t bytes) {
+    if (buffer == nullptr) return;
+
+    size_t bucket = bucketSize(bytes);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (idleBytes + bucket <= retainLimit) {
+            idle[bucket].push_back(buffer);
+            idleBytes += bucket;
+            return;
+        }
+    }
+    trackedFree(buffer);
+}
+
+void ImageBufferPool::trim() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [bucket, buffers] : idle) {
+        for (void* buffer : buffers) trackedFree(buffer);
+        buffers.clear();
+    }
+    idleBytes = 0;
+}
+
+void ImageBufferPool::setRetainLimit(size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        retainLimit = bytes;
+    }
+    if (bytes == 0) trim();
+}
+
+size_t ImageBufferPool::hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hitCount;
+}
+
+size_t ImageBufferPool::misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return missCount;
+}
+
+ImageBufferPool::~ImageBufferPool() {
+    trim();
+}
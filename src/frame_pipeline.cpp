@@ -0,0 +1,133 @@
+#include "../include/frame_pipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+struct PendingFrame {
+    int index = 0;
+    int delayMs = 0;
+    Image image;
+};
+
+} // namespace
+
+bool runFramePipeline(const FrameSource& source, const FrameConverter& convert, const FrameSink& sink,
+                      int workers, int window, PipelineStats& stats) {
+    workers = workers > 0 ? workers : resolveThreadCount();
+    window = window > 0 ? window : 2 * workers;
+    stats = PipelineStats{};
+
+    // One condition variable for every state change; waiters re-check their predicate
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<PendingFrame> queued;        // read, waiting for a worker
+    std::map<int, PipelineFrame> converted;  // waiting for their turn at the sink
+    int read = 0;
+    int delivered = 0;
+    bool sourceDone = false;
+    bool failed = false;
+
+    std::thread reader([&]() {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return failed || read - delivered < window; });
+                if (failed) return;
+            }
+            PendingFrame frame;
+            bool ok = source(frame.image, frame.delayMs);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!ok) {
+                sourceDone = true;
+                changed.notify_all();
+                return;
+            }
+            frame.index = read++;
+            queued.push_back(std::move(frame));
+            stats.peakInFlight = std::max(stats.peakInFlight, read - delivered);
+            changed.notify_all();
+        }
+    });
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers);
+    for (int t = 0; t < workers; ++t) {
+        pool.emplace_back([&]() {
+            g_frameWorker = true;
+            for (;;) {
+                PendingFrame frame;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&] { return failed || sourceDone || !queued.empty(); });
+                    if (failed || queued.empty()) return;
+                    frame = std::move(queued.front());
+                    queued.pop_front();
+                }
+
+                PipelineFrame out;
+                out.index = frame.index;
+                out.delayMs = frame.delayMs;
+                auto start = std::chrono::high_resolution_clock::now();
+                bool ok = convert(frame.image, out);
+                out.convertMs = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+                    std::chrono::high_resolution_clock::now() - start).count();
+                frame.image = Image();  // the full-size frame is not needed past this point
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if (ok) {
+                    converted.emplace(out.index, std::move(out));
+                } else {
+                    failed = true;
+                }
+                changed.notify_all();
+            }
+        });
+    }
+
+    // Deliver in order on the calling thread
+    bool ok = true;
+    for (;;) {
+        PipelineFrame frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] {
+                return failed || converted.count(delivered) != 0 || (sourceDone && delivered == read);
+            });
+            auto it = converted.find(delivered);
+            if (failed || it == converted.end()) {
+                ok = !failed;
+                break;
+            }
+            frame = std::move(it->second);
+            converted.erase(it);
+        }
+
+        bool accepted = sink(frame);
+        std::lock_guard<std::mutex> lock(mutex);
+        ++delivered;
+        if (!accepted) {
+            failed = true;
+            ok = false;
+        }
+        changed.notify_all();
+        if (!accepted) break;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!ok) failed = true;
+        changed.notify_all();
+    }
+    reader.join();
+    for (auto& th : pool) th.join();
+
+    stats.frames = delivered;
+    return ok;
+}
@@ -1,16 +1,49 @@
 #include "../include/image_converter.h"
+#include "../include/glyph_masks.h"
 #include <iostream>
 #include <thread>
 #include <vector>
 #include <mutex>
 #include <cmath>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+// Per-thread "last call" statistics: watch and frame workers convert whole
+// images concurrently, each reading back the figures of its own image
 
-// Global luminance buffer used by ASM path. Defined here.
-float* g_lumaBuffer = nullptr;
 // last HSV time in milliseconds
-double g_lastHsvMs = std::nan("");
+thread_local double g_lastHsvMs = std::nan("");
 
+// share of inner pixels the last detectEdgesSobel call skipped as flat
+thread_local double g_lastSobelSkipRatio = 0.0;
+
+// share of cells the last matchGlyphStructure call redrew by shape
+thread_local double g_lastStructureRatio = 0.0;
+
+thread_local bool g_frameWorker = false;
+
+int resolveThreadCount() {
+    if (g_frameWorker) return 1;
+    int threadCount = g_threadCount;
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+        if (threadCount <= 0) threadCount = 1;
+    }
+    if (threadCount > 64) threadCount = 64;
+    return threadCount;
+}
+
+int resolveSobelThreadCount() {
+    if (g_frameWorker || g_sobelThreadCount <= 0) return resolveThreadCount();
+    return std::min(g_sobelThreadCount, 64);
+}
 
 // ============================================================================
 // HSV CONVERSION IMPLEMENTATION
@@ -30,79 +63,118 @@ PixelHSV rgbToHsv(float r, float g, float b) {
     }
 }
 
+// A bucket's class is the rule applied to the HSV of its centre
+static std::unique_ptr<HsvLut> buildHsvLut(const HueRule& rule) {
+    auto lut = std::make_unique<HsvLut>();
+    const float top = static_cast<float>(AsciiCharMap::densityLevels - 1);
+    for (int v = 0; v < 256; ++v) {
+        // Same expression as rampValue on the HSV batch's value
+        lut->ramp[v] = std::max(0.0f, std::min(1.0f, v / 255.0f)) * top;
+    }
+    for (size_t i = 0; i < kHsvLutSize; ++i) {
+        float r = static_cast<float>(((i >> 11) << 3) | 4) / 255.0f;
+        float g = static_cast<float>((((i >> 5) & 0x3F) << 2) | 2) / 255.0f;
+        float b = static_cast<float>(((i & 0x1F) << 3) | 4) / 255.0f;
+        PixelHSV hsv = rgbToHsvCpp(r, g, b);
+        lut->hueClass[i] = rule.matches(hsv.h, hsv.s) ? kHueClassRule : 0;
+    }
+    return lut;
+}
+
+const HsvLut& hsvLut() {
+    static const std::unique_ptr<HsvLut> lut = buildHsvLut(g_hueRule);
+    return *lut;
+}
+
 // ============================================================================
 // IMAGE SCALING IMPLEMENTATION
 // ============================================================================
 
+void scaleRowBilinear(
+    const unsigned char* row0,
+    const unsigned char* row1,
+    int srcWidth,
+    int channels,
+    float fy,
+    unsigned char* dstRow,
+    int targetWidth
+) {
+    float scaleX = static_cast<float>(srcWidth) / targetWidth;
+
+    for (int x = 0; x < targetWidth; ++x) {
+        float srcX = x * scaleX;
+
+        // Skip if out of bounds
+        if (srcX >= srcWidth - 1) {
+            // Fill with black/background
+            for (int c = 0; c < channels; ++c) {
+                dstRow[x * channels + c] = 0;
+            }
+            continue;
+        }
+
+        // Clamp coordinates to valid range
+        int x0 = static_cast<int>(srcX);
+        x0 = std::max(0, std::min(x0, srcWidth - 2));
+        int x1 = x0 + 1;
+
+        float fx = srcX - x0;
+        // Clamp fractions to [0, 1]
+        fx = std::max(0.0f, std::min(1.0f, fx));
+
+        // Bilinear interpolation
+        for (int c = 0; c < channels; ++c) {
+            float v00 = row0[x0 * channels + c] / 255.0f;
+            float v10 = row0[x1 * channels + c] / 255.0f;
+            float v01 = row1[x0 * channels + c] / 255.0f;
+            float v11 = row1[x1 * channels + c] / 255.0f;
+
+            float v0 = v00 * (1 - fx) + v10 * fx;
+            float v1 = v01 * (1 - fx) + v11 * fx;
+            float v = v0 * (1 - fy) + v1 * fy;
+
+            dstRow[x * channels + c] = static_cast<unsigned char>(v * 255.0f);
+        }
+    }
+}
+
 Image scaleImage(const Image& src, int targetWidth, int targetHeight, float aspectRatio) {
     if (!src.isValid() || targetWidth <= 0 || targetHeight <= 0) {
         return Image();
     }
 
-    Image dst;
-    dst.width = targetWidth;
-    dst.height = targetHeight;
-    dst.channels = src.channels;
-    dst.data = new unsigned char[targetWidth * targetHeight * src.channels]{};
+    // Padded rows: every row the Sobel/HSV passes walk starts on a 64-byte boundary
+    Image dst = Image::allocate(targetWidth, targetHeight, src.channels, ImageStorage::Aligned);
+    if (!dst.isValid()) {
+        return dst;
+    }
 
     // Calculate scale factors
     // Aspect ratio correction: terminal chars are ~2x taller than wide
     // We sample the source image with adjusted coordinates
-    float scaleX = static_cast<float>(src.width) / targetWidth;
     float scaleY = static_cast<float>(src.height) / targetHeight;
 
     for (int y = 0; y < targetHeight; ++y) {
-        for (int x = 0; x < targetWidth; ++x) {
-            float srcX = x * scaleX;
-            float srcY = y * scaleY;
-
-            // Skip if out of bounds
-            if (srcY >= src.height - 1 || srcX >= src.width - 1) {
-                // Fill with black/background
-                for (int c = 0; c < src.channels; ++c) {
-                    int dstIdx = (y * targetWidth + x) * src.channels + c;
-                    dst.data[dstIdx] = 0;
-                }
-                continue;
-            }
+        float srcY = y * scaleY;
+        unsigned char* dstRow = dst.row(y);
 
-            // Clamp coordinates to valid range
-            int x0 = static_cast<int>(srcX);
-            int y0 = static_cast<int>(srcY);
-
-            x0 = std::max(0, std::min(x0, src.width - 2));
-            y0 = std::max(0, std::min(y0, src.height - 2));
-
-            int x1 = x0 + 1;
-            int y1 = y0 + 1;
-
-            float fx = srcX - x0;
-            float fy = srcY - y0;
-
-            // Clamp fractions to [0, 1]
-            fx = std::max(0.0f, std::min(1.0f, fx));
-            fy = std::max(0.0f, std::min(1.0f, fy));
-
-            // Bilinear interpolation
-            for (int c = 0; c < src.channels; ++c) {
-                int idx00 = (y0 * src.width + x0) * src.channels + c;
-                int idx10 = (y0 * src.width + x1) * src.channels + c;
-                int idx01 = (y1 * src.width + x0) * src.channels + c;
-                int idx11 = (y1 * src.width + x1) * src.channels + c;
+        // Rows past the last source pair are black/background
+        if (srcY >= src.height - 1) {
+            std::memset(dstRow, 0, static_cast<size_t>(targetWidth) * src.channels);
+            continue;
+        }
 
-                float v00 = src.data[idx00] / 255.0f;
-                float v10 = src.data[idx10] / 255.0f;
-                float v01 = src.data[idx01] / 255.0f;
-                float v11 = src.data[idx11] / 255.0f;
+        int y0 = static_cast<int>(srcY);
+        y0 = std::max(0, std::min(y0, src.height - 2));
 
-                float v0 = v00 * (1 - fx) + v10 * fx;
-                float v1 = v01 * (1 - fx) + v11 * fx;
-                float v = v0 * (1 - fy) + v1 * fy;
+        float fy = srcY - y0;
+        fy = std::max(0.0f, std::min(1.0f, fy));
 
-                int dstIdx = (y * targetWidth + x) * src.channels + c;
-                dst.data[dstIdx] = static_cast<unsigned char>(v * 255.0f);
-            }
-        }
+        scaleRowBilinear(
+            src.row(y0),
+            src.row(y0 + 1),
+            src.width, src.channels, fy, dstRow, targetWidth
+        );
     }
 
     return dst;
@@ -127,182 +199,830 @@ EdgeMap::~EdgeMap() {
 // SOBEL EDGE DETECTION IMPLEMENTATION
 // ============================================================================
 
-// Single-threaded Sobel for a block of pixels
-static void sobelBlock(
-    const Image& img,
-    EdgeMap& edges,
-    int startY,
-    int endY
-) {
-    if (!img.isValid() || !edges.isValid()) return;
+// Working-set budget for one Sobel tile (three luma rows plus the outputs)
+static constexpr size_t kSobelL1Bytes = 32 * 1024;
 
-    // Sobel kernels
-    int sobelX[3][3] = {
-        {-1, 0, 1},
-        {-2, 0, 2},
-        {-1, 0, 1}
-    };
+// C++ kernel tile; also the granularity of the flat-region skip
+static constexpr int kSobelTileCols = 32;
+static constexpr int kSobelTileRows = 8;
 
-    int sobelY[3][3] = {
-        {-1, -2, -1},
-        {0, 0, 0},
-        {1, 2, 1}
-    };
+// Same weights and rounding as getLuminance (BT.709 on normalized RGB)
+static inline float pixelLuminance(const unsigned char* p, int channels) {
+    if (channels == 1) return p[0] / 255.0f;
+    if (channels < 3) return 0.0f;
+    return 0.2126f * (p[0] / 255.0f) + 0.7152f * (p[1] / 255.0f) + 0.0722f * (p[2] / 255.0f);
+}
 
-    float maxGradient = 0.0f;
+// Run fn(startY, endY) over the inner rows [1, height-1) split into one band per worker
+template <typename Fn>
+static void forEachSobelBand(int height, int threadCount, Fn fn) {
+    int innerStart = 1;
+    int innerEnd = std::max(1, height - 1);
+    int rows = innerEnd - innerStart;
+    if (rows <= 0) return;
+
+    threadCount = std::max(1, std::min(threadCount, rows));
+    if (threadCount == 1) {
+        fn(0, innerStart, innerEnd);
+        return;
+    }
 
-    for (int y = std::max(1, startY); y < std::min(img.height - 1, endY); ++y) {
-        for (int x = 1; x < img.width - 1; ++x) {
-            float gx = 0.0f, gy = 0.0f;
+    int block = (rows + threadCount - 1) / threadCount;
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (int t = 0; t < threadCount; ++t) {
+        int s = innerStart + t * block;
+        int e = std::min(innerEnd, s + block);
+        if (s >= e) break;
+        workers.emplace_back([&fn, t, s, e]() { fn(t, s, e); });
+    }
+    for (auto& th : workers) th.join();
+}
 
-            // Apply Sobel kernels
-            for (int ky = -1; ky <= 1; ++ky) {
-                for (int kx = -1; kx <= 1; ++kx) {
-                    float pixel = getLuminance(img, x + kx, y + ky);
-                    gx += pixel * sobelX[ky + 1][kx + 1];
-                    gy += pixel * sobelY[ky + 1][kx + 1];
-                }
+// Run fn(worker) on threadCount threads (inline when there is only one)
+template <typename Fn>
+static void forEachSobelWorker(int threadCount, Fn fn) {
+    if (threadCount <= 1) {
+        fn(0);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (int t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&fn, t]() { fn(t); });
+    }
+    for (auto& th : workers) th.join();
+}
+
+// Inner pixels [x0, x1) x [y0, y1) plus an upper bound on any gradient inside
+struct SobelTile {
+    int x0, x1;
+    int y0, y1;
+    float bound;
+};
+
+// Upper bound on the Sobel magnitude anywhere in the tile, from the byte range
+// of each channel over the tile and its one-pixel halo. Luma is a convex mix
+// of R, G and B, so its range is at most the weighted channel ranges; each
+// kernel has +4/-4 total weight, so |Gx|, |Gy| <= 4 * range. The weights are
+// those of the kernel that runs: the ASM kernel computes BT.601 luma, whose
+// red and blue weights are larger than BT.709's.
+// A single-channel image is its own luma.
+static float sobelTileBound(const Image& img, const SobelTile& tile) {
+    const int c = img.channels;
+    if (c == 2) return 0.0f;  // luma is constant zero
+    const int planes = c == 1 ? 1 : 3;
+
+    unsigned char lo[3] = {255, 255, 255};
+    unsigned char hi[3] = {0, 0, 0};
+    for (int y = tile.y0 - 1; y <= tile.y1; ++y) {
+        const unsigned char* p = img.row(y) + static_cast<size_t>(tile.x0 - 1) * c;
+        const unsigned char* end = img.row(y) + static_cast<size_t>(tile.x1 + 1) * c;
+        for (; p < end; p += c) {
+            for (int k = 0; k < planes; ++k) {
+                lo[k] = std::min(lo[k], p[k]);
+                hi[k] = std::max(hi[k], p[k]);
             }
+        }
+    }
+
+    const bool bt601 = sobelUsesAsm(img);
+    float range = planes == 1
+        ? (hi[0] - lo[0]) / 255.0f
+        : (bt601 ? 0.299f : 0.2126f) * ((hi[0] - lo[0]) / 255.0f)
+        + (bt601 ? 0.587f : 0.7152f) * ((hi[1] - lo[1]) / 255.0f)
+        + (bt601 ? 0.114f : 0.0722f) * ((hi[2] - lo[2]) / 255.0f);
+    return 4.0f * std::sqrt(2.0f) * range;
+}
+
+// Sobel over one tile, returns the tile's max magnitude.
+// The tile keeps a ring of three luma rows (with a one-pixel halo) and slides
+// down, so every luma value is computed once per tile instead of once per
+// kernel tap.
+static float sobelTile(
+    const Image& img,
+    EdgeMap& edges,
+    const SobelTile& tile,
+    std::vector<float>& ring
+) {
+    const int w = img.width;
+    const int c = img.channels;
+    const int x0 = tile.x0;
+    const int x1 = tile.x1;
+    const int span = x1 - x0 + 2;  // columns x0-1 .. x1
+    ring.resize(3 * static_cast<size_t>(span));
+    float maxGradient = 0.0f;
+
+    auto slot = [&](int y) { return ring.data() + ((y - tile.y0 + 1) % 3) * span; };
+    auto fillRow = [&](int y) {
+        const unsigned char* src = img.row(y) + static_cast<size_t>(x0 - 1) * c;
+        float* dst = slot(y);
+        for (int i = 0; i < span; ++i) {
+            dst[i] = pixelLuminance(src + i * c, c);
+        }
+    };
+
+    fillRow(tile.y0 - 1);
+    fillRow(tile.y0);
+
+    for (int y = tile.y0; y < tile.y1; ++y) {
+        fillRow(y + 1);
+        const float* top = slot(y - 1);
+        const float* mid = slot(y);
+        const float* bot = slot(y + 1);
+        float* magRow = edges.magnitudes + static_cast<size_t>(y) * w;
+        float* angRow = edges.angles + static_cast<size_t>(y) * w;
+
+        for (int x = x0; x < x1; ++x) {
+            const int i = x - x0 + 1;
+            // Same accumulation order as the 3x3 kernel loop (zero taps dropped)
+            float gx = -top[i - 1];
+            gx += top[i + 1];
+            gx += mid[i - 1] * -2;
+            gx += mid[i + 1] * 2;
+            gx += -bot[i - 1];
+            gx += bot[i + 1];
+
+            float gy = -top[i - 1];
+            gy += top[i] * -2;
+            gy += -top[i + 1];
+            gy += bot[i - 1];
+            gy += bot[i] * 2;
+            gy += bot[i + 1];
 
             float magnitude = std::sqrt(gx * gx + gy * gy);
             float angle = std::atan2(gy, gx) * 180.0f / M_PI;
             if (angle < 0) angle += 180.0f;
 
-            int idx = y * img.width + x;
+            magRow[x] = magnitude;
+            angRow[x] = angle;
+            maxGradient = std::max(maxGradient, magnitude);
+        }
+    }
+
+    return maxGradient;
+}
+
+// Sobel through the ASM kernel over full-width rows [tile.y0, tile.y1).
+// The kernel converts its whole input to luma first, so it is fed the tile
+// rows plus a one-row halo; Gx/Gy land in the magnitude/angle rows and are
+// turned into magnitude/angle in place.
+static float sobelTileAsm(
+    const Image& img,
+    EdgeMap& edges,
+    const SobelTile& tile,
+    std::vector<float>& luma
+) {
+    const int w = img.width;
+    const int rows = tile.y1 - tile.y0;
+    const size_t base = static_cast<size_t>(tile.y0 - 1);
+    luma.resize(static_cast<size_t>(rows + 2) * w);
+
+    sobelGradients(img.row(tile.y0 - 1), w, rows + 2, static_cast<int>(img.stride), 1, rows + 1,
+                   edges.magnitudes + base * w, edges.angles + base * w, luma.data());
+
+    float maxGradient = 0.0f;
+    for (int y = tile.y0; y < tile.y1; ++y) {
+        for (int x = 1; x < w - 1; ++x) {
+            size_t idx = static_cast<size_t>(y) * w + x;
+            float vx = edges.magnitudes[idx];
+            float vy = edges.angles[idx];
+            float magnitude = std::sqrt(vx * vx + vy * vy);
+            float angle = std::atan2(vy, vx) * 180.0f / M_PI;
+            if (angle < 0) angle += 180.0f;
             edges.magnitudes[idx] = magnitude;
             edges.angles[idx] = angle;
-
             maxGradient = std::max(maxGradient, magnitude);
         }
     }
+    return maxGradient;
+}
 
-    // Normalize magnitudes
-    if (maxGradient > 0.0f) {
-        for (int y = std::max(1, startY); y < std::min(img.height - 1, endY); ++y) {
-            for (int x = 1; x < img.width - 1; ++x) {
-                int idx = y * img.width + x;
-                edges.magnitudes[idx] /= maxGradient;
-            }
+float sobelRegion(const Image& img, EdgeMap& edges, int x0, int y0, int x1, int y1) {
+    if (!img.isValid() || edges.width != img.width || edges.height != img.height) {
+        return 0.0f;
+    }
+    const int w = img.width;
+    const int h = img.height;
+    y0 = std::max(1, y0);
+    y1 = std::min(h - 1, y1);
+    if (w < 3 || y0 >= y1) return 0.0f;
+
+    std::vector<float> scratch;
+    if (sobelUsesAsm(img)) {
+        const int chunkRows = std::max(8, static_cast<int>(kSobelL1Bytes / (static_cast<size_t>(w) * sizeof(float))) - 2);
+        float maxGradient = 0.0f;
+        for (int y = y0; y < y1; y += chunkRows) {
+            SobelTile tile{1, w - 1, y, std::min(y1, y + chunkRows), 0.0f};
+            maxGradient = std::max(maxGradient, sobelTileAsm(img, edges, tile, scratch));
         }
+        return maxGradient;
     }
+
+    x0 = std::max(1, x0);
+    x1 = std::min(w - 1, x1);
+    if (x0 >= x1) return 0.0f;
+    return sobelTile(img, edges, SobelTile{x0, x1, y0, y1, 0.0f}, scratch);
 }
 
-EdgeMap detectEdgesSobel(const Image& img, int blockSize) {
+// Normalized Sobel; tiles that cannot exceed skipThreshold (normalized) may be left at zero
+static EdgeMap sobelEdges(const Image& img, float skipThreshold) {
     EdgeMap edges(img.width, img.height);
+    g_lastSobelSkipRatio = 0.0;
 
-    if (!img.isValid()) {
+    if (!img.isValid() || img.width < 3 || img.height < 3) {
         return edges;
     }
 
-    if (g_sobelAsm) {
-        // Use assembly accelerated Sobel to compute Gx and Gy, then derive magnitudes/angles
-        int w = img.width;
-        int h = img.height;
-        size_t total = static_cast<size_t>(w) * static_cast<size_t>(h);
-        float* gx = new float[total]();
-        float* gy = new float[total]();
-
-        // Ensure luminance buffer exists for ASM implementation to use
-        if (!g_lumaBuffer) {
-            g_lumaBuffer = new float[total]();
-        }
-
-        // Determine thread count (0 = auto)
-        int threadCount = g_threadCount;
-        if (threadCount <= 0) {
-            threadCount = static_cast<int>(std::thread::hardware_concurrency());
-            if (threadCount <= 0) threadCount = 1;
-        }
-        if (threadCount > 64) threadCount = 64;
-
-        if (threadCount == 1) {
-            // Single worker: compute whole image
-            sobelGradients(img.data, w, h, img.channels, 0, h, gx, gy, g_lumaBuffer);
-        } else {
-            // Partition inner rows [1, h-1) across threads (edges remain 0)
-            int innerStart = 1;
-            int innerEnd = std::max(1, h - 1);
-            int rows = innerEnd - innerStart;
-            if (rows > 0) {
-                int block = (rows + threadCount - 1) / threadCount;
-                std::vector<std::thread> workers;
-                workers.reserve(threadCount);
-                for (int t = 0; t < threadCount; ++t) {
-                    int s = innerStart + t * block;
-                    int e = s + block;
-                    if (s >= innerEnd) break;
-                    if (e > innerEnd) e = innerEnd;
-                    // Launch worker computing rows [s, e)
-                    workers.emplace_back([&img, s, e, gx, gy, w, h]() {
-                        sobelGradients(img.data, w, h, img.channels, s, e, gx, gy, g_lumaBuffer);
-                    });
-                }
-                for (auto& th : workers) th.join();
-            }
+    const int w = img.width;
+    const int h = img.height;
+
+    // The ASM kernel walks the buffer as full rows, so its tiles are row
+    // chunks sized to keep the luma scratch in L1
+    const bool useAsm = sobelUsesAsm(img);
+    const int tileCols = useAsm ? w - 2 : kSobelTileCols;
+    const int tileRows = useAsm
+        ? std::max(8, static_cast<int>(kSobelL1Bytes / (static_cast<size_t>(w) * sizeof(float))) - 2)
+        : kSobelTileRows;
+
+    std::vector<SobelTile> tiles;
+    for (int y0 = 1; y0 < h - 1; y0 += tileRows) {
+        for (int x0 = 1; x0 < w - 1; x0 += tileCols) {
+            tiles.push_back({x0, std::min(w - 1, x0 + tileCols), y0, std::min(h - 1, y0 + tileRows), 0.0f});
         }
+    }
 
-        // Compute magnitudes and angles, track max gradient
-        float maxGradient = 0.0f;
-        for (int y = 1; y < h - 1; ++y) {
-            for (int x = 1; x < w - 1; ++x) {
-                int idx = y * w + x;
-                float vx = gx[idx];
-                float vy = gy[idx];
-                float magnitude = std::sqrt(vx * vx + vy * vy);
-                float angle = std::atan2(vy, vx) * 180.0f / M_PI;
-                if (angle < 0) angle += 180.0f;
-                edges.magnitudes[idx] = magnitude;
-                edges.angles[idx] = angle;
-                maxGradient = std::max(maxGradient, magnitude);
+    const int threadCount = std::max(1, std::min(resolveSobelThreadCount(), static_cast<int>(tiles.size())));
+
+    // Flat-region pre-pass: bound every tile, then visit tiles from the
+    // busiest down. Once a tile's bound cannot reach the edge threshold
+    // relative to the largest gradient seen so far, it cannot produce an
+    // edge glyph (nor the global max), so it is left at zero.
+    if (g_sobelFlatSkip) {
+        forEachSobelWorker(threadCount, [&](int t) {
+            for (size_t i = t; i < tiles.size(); i += threadCount) {
+                tiles[i].bound = sobelTileBound(img, tiles[i]);
+            }
+        });
+        std::stable_sort(tiles.begin(), tiles.end(),
+                         [](const SobelTile& a, const SobelTile& b) { return a.bound > b.bound; });
+    }
+
+    std::atomic<size_t> nextTile{0};
+    std::atomic<float> runningMax{0.0f};
+    std::atomic<size_t> skippedPixels{0};
+
+    forEachSobelWorker(threadCount, [&](int) {
+        std::vector<float> scratch;
+        size_t skipped = 0;
+        for (size_t i = nextTile.fetch_add(1); i < tiles.size(); i = nextTile.fetch_add(1)) {
+            const SobelTile& tile = tiles[i];
+            // 1% margin covers float rounding in the bound and the kernel
+            if (g_sobelFlatSkip && tile.bound * 1.01f <= skipThreshold * runningMax.load()) {
+                skipped += static_cast<size_t>(tile.x1 - tile.x0) * (tile.y1 - tile.y0);
+                continue;
+            }
+
+            float tileMax = useAsm ? sobelTileAsm(img, edges, tile, scratch)
+                                   : sobelTile(img, edges, tile, scratch);
+            float seen = runningMax.load();
+            while (tileMax > seen && !runningMax.compare_exchange_weak(seen, tileMax)) {
             }
         }
+        skippedPixels += skipped;
+    });
+
+    g_lastSobelSkipRatio = static_cast<double>(skippedPixels.load())
+                         / (static_cast<double>(w - 2) * (h - 2));
 
-        // Normalize magnitudes
-        if (maxGradient > 0.0f) {
-            for (int y = 1; y < h - 1; ++y) {
+    // Normalize magnitudes against the global maximum so the result does not
+    // depend on how tiles were split across threads
+    float maxGradient = runningMax.load();
+    if (maxGradient > 0.0f) {
+        forEachSobelBand(h, threadCount, [&](int, int s, int e) {
+            for (int y = s; y < e; ++y) {
+                float* magRow = edges.magnitudes + static_cast<size_t>(y) * w;
                 for (int x = 1; x < w - 1; ++x) {
-                    int idx = y * w + x;
-                    edges.magnitudes[idx] /= maxGradient;
+                    magRow[x] /= maxGradient;
                 }
             }
+        });
+    }
+
+    return edges;
+}
+
+EdgeMap detectEdgesSobel(const Image& img, int blockSize) {
+    return sobelEdges(img, kEdgeThreshold);
+}
+
+// ============================================================================
+// CANNY EDGE DETECTION IMPLEMENTATION
+// ============================================================================
+
+static constexpr uint32_t kNotWeak = 0xffffffffu;
+
+// Lock-free union-find over pixel indices: roots only ever link to a smaller
+// index with a CAS, and path halving only shortcuts to an ancestor, so
+// concurrent finds/unions from different bands are safe.
+static uint32_t findRoot(std::atomic<uint32_t>* parent, uint32_t p) {
+    uint32_t next = parent[p].load(std::memory_order_relaxed);
+    while (next != p) {
+        uint32_t grand = parent[next].load(std::memory_order_relaxed);
+        if (grand != next) {
+            parent[p].compare_exchange_weak(next, grand, std::memory_order_relaxed);
         }
+        p = next;
+        next = parent[p].load(std::memory_order_relaxed);
+    }
+    return p;
+}
+
+static void unite(std::atomic<uint32_t>* parent, uint32_t a, uint32_t b) {
+    while (true) {
+        a = findRoot(parent, a);
+        b = findRoot(parent, b);
+        if (a == b) return;
+        if (a < b) std::swap(a, b);
+        uint32_t expected = a;
+        if (parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) return;
+    }
+}
 
-        delete[] gx;
-        delete[] gy;
-        // free luminance buffer
-        if (g_lumaBuffer) {
-            delete[] g_lumaBuffer;
-            g_lumaBuffer = nullptr;
+// Non-maximum suppression of rows [s, e) along the gradient direction,
+// quantized into the same four bins as getEdgeChar. Branch-free so the
+// inner loop vectorizes.
+static void suppressBand(const EdgeMap& gradients, float* suppressed, int s, int e) {
+    const int w = gradients.width;
+    for (int y = s; y < e; ++y) {
+        const float* top = gradients.magnitudes + static_cast<size_t>(y - 1) * w;
+        const float* mid = gradients.magnitudes + static_cast<size_t>(y) * w;
+        const float* bot = gradients.magnitudes + static_cast<size_t>(y + 1) * w;
+        const float* ang = gradients.angles + static_cast<size_t>(y) * w;
+        float* out = suppressed + static_cast<size_t>(y) * w;
+
+        for (int x = 1; x < w - 1; ++x) {
+            const float angle = ang[x];
+            // 0 = '-' (horizontal gradient), 1 = '/', 2 = '|', 3 = '\'
+            int bin = (angle >= 22.5f) + (angle >= 67.5f) + (angle >= 112.5f);
+            bin = (angle >= 157.5f) ? 0 : bin;
+
+            float a = mid[x - 1];
+            float b = mid[x + 1];
+            a = (bin == 1) ? top[x - 1] : a;
+            b = (bin == 1) ? bot[x + 1] : b;
+            a = (bin == 2) ? top[x] : a;
+            b = (bin == 2) ? bot[x] : b;
+            a = (bin == 3) ? top[x + 1] : a;
+            b = (bin == 3) ? bot[x - 1] : b;
+
+            const float m = mid[x];
+            out[x] = (m >= a && m > b) ? m : 0.0f;
         }
+    }
+}
+
+EdgeMap detectEdgesCanny(const Image& img, float lowThreshold, float highThreshold) {
+    // Pixels below the low threshold can neither be kept nor suppress a kept
+    // neighbour, so flat tiles may be skipped against it
+    EdgeMap edges = sobelEdges(img, lowThreshold);
+    if (!edges.isValid() || img.width < 3 || img.height < 3) {
         return edges;
     }
 
-    int numThreads = std::thread::hardware_concurrency();
-    if (numThreads == 0) numThreads = 1;
+    const int w = img.width;
+    const int h = img.height;
+    const size_t total = static_cast<size_t>(w) * h;
+    const int threadCount = resolveThreadCount();
+
+    std::vector<float> suppressed(total, 0.0f);
+    forEachSobelBand(h, threadCount, [&](int, int s, int e) {
+        suppressBand(edges, suppressed.data(), s, e);
+    });
+
+    // Hysteresis: connected components of weak pixels (8-connected), kept
+    // when any member is strong. Each pass runs on row bands in parallel.
+    std::unique_ptr<std::atomic<uint32_t>[]> parent(new std::atomic<uint32_t>[total]);
+    std::unique_ptr<std::atomic<unsigned char>[]> strongRoot(new std::atomic<unsigned char>[total]);
+
+    auto forAllRows = [&](auto fn) {
+        int rows = h;
+        int count = std::max(1, std::min(threadCount, rows));
+        int block = (rows + count - 1) / count;
+        forEachSobelWorker(count, [&](int t) {
+            fn(t * block, std::min(rows, (t + 1) * block));
+        });
+    };
+
+    forAllRows([&](int s, int e) {
+        for (size_t p = static_cast<size_t>(s) * w; p < static_cast<size_t>(e) * w; ++p) {
+            parent[p].store(suppressed[p] >= lowThreshold ? static_cast<uint32_t>(p) : kNotWeak,
+                            std::memory_order_relaxed);
+            strongRoot[p].store(0, std::memory_order_relaxed);
+        }
+    });
+
+    forEachSobelBand(h, threadCount, [&](int, int s, int e) {
+        for (int y = s; y < e; ++y) {
+            for (int x = 1; x < w - 1; ++x) {
+                uint32_t p = static_cast<uint32_t>(static_cast<size_t>(y) * w + x);
+                if (parent[p].load(std::memory_order_relaxed) == kNotWeak) continue;
+                // Left and the three upper neighbours cover every 8-connected pair once
+                const uint32_t neighbours[4] = {p - 1, p - w - 1, p - w, p - w + 1};
+                for (uint32_t q : neighbours) {
+                    if (parent[q].load(std::memory_order_relaxed) != kNotWeak) unite(parent.get(), p, q);
+                }
+            }
+        }
+    });
 
-    int blockHeight = std::max(1, img.height / numThreads);
-    std::vector<std::thread> threads;
+    forAllRows([&](int s, int e) {
+        for (size_t p = static_cast<size_t>(s) * w; p < static_cast<size_t>(e) * w; ++p) {
+            if (suppressed[p] >= highThreshold && parent[p].load(std::memory_order_relaxed) != kNotWeak) {
+                strongRoot[findRoot(parent.get(), static_cast<uint32_t>(p))].store(1, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    // Kept pixels get magnitude 1 so convertToAscii draws them; angles stay
+    forAllRows([&](int s, int e) {
+        for (size_t p = static_cast<size_t>(s) * w; p < static_cast<size_t>(e) * w; ++p) {
+            bool keep = parent[p].load(std::memory_order_relaxed) != kNotWeak
+                     && strongRoot[findRoot(parent.get(), static_cast<uint32_t>(p))].load(std::memory_order_relaxed);
+            edges.magnitudes[p] = keep ? 1.0f : 0.0f;
+        }
+    });
 
-    for (int t = 0; t < numThreads; ++t) {
-        int startY = t * blockHeight;
-        int endY = (t == numThreads - 1) ? img.height : (t + 1) * blockHeight;
+    return edges;
+}
 
-        threads.emplace_back([&img, &edges, startY, endY]() {
-            sobelBlock(img, edges, startY, endY);
-        });
+EdgeMap detectEdges(const Image& img) {
+    if (g_edgeMode == EdgeMode::Canny) {
+        return detectEdgesCanny(img, g_cannyLow, g_cannyHigh);
+    }
+    return detectEdgesSobel(img);
+}
+
+// ============================================================================
+// LEVELS (AUTO-CONTRAST / EQUALIZATION) IMPLEMENTATION
+// ============================================================================
+
+// Share of pixels clipped at each end by auto-contrast
+static constexpr double kLevelsClip = 0.005;
+// Below this many pixels per worker the histogram is built on one thread
+static constexpr size_t kLevelsPixelsPerThread = 64 * 1024;
+
+// 8-bit bin of a luminance value, as used by the glyph lookup
+static inline int lumaBin(float luminance) {
+    return std::max(0, std::min(255, static_cast<int>(luminance * 255.0f + 0.5f)));
+}
+
+static inline unsigned char glyphLevel(float value) {
+    value = std::max(0.0f, std::min(1.0f, value));
+    int level = static_cast<int>(value * (AsciiCharMap::densityLevels - 1));
+    return static_cast<unsigned char>(std::max(0, std::min(AsciiCharMap::densityLevels - 1, level)));
+}
+
+bool buildLevelsLut(const Image& img, LevelsMode mode, LevelsLut& lut) {
+    if (!img.isValid() || mode == LevelsMode::Off) return false;
+
+    // Per-thread private histograms (one cache-line aligned block each), merged at the end
+    struct alignas(64) Histogram {
+        std::array<uint32_t, 256> bins{};
+    };
+    const size_t totalPixels = static_cast<size_t>(img.width) * img.height;
+    const int threadCount = static_cast<int>(std::max<size_t>(1, std::min<size_t>(
+        static_cast<size_t>(resolveThreadCount()),
+        std::min<size_t>(img.height, totalPixels / kLevelsPixelsPerThread))));
+    std::vector<Histogram> partial(threadCount);
+    const int block = (img.height + threadCount - 1) / threadCount;
+
+    forEachSobelWorker(threadCount, [&](int t) {
+        std::array<uint32_t, 256>& bins = partial[t].bins;
+        for (int y = t * block; y < std::min(img.height, (t + 1) * block); ++y) {
+            const unsigned char* p = img.row(y);
+            for (int x = 0; x < img.width; ++x, p += img.channels) {
+                ++bins[lumaBin(pixelLuminance(p, img.channels))];
+            }
+        }
+    });
+
+    std::array<uint64_t, 256> histogram{};
+    for (const Histogram& h : partial) {
+        for (int i = 0; i < 256; ++i) histogram[i] += h.bins[i];
     }
 
-    for (auto& thread : threads) {
-        thread.join();
+    if (mode == LevelsMode::Equalize) {
+        // Map each bin to its share of the cumulative distribution
+        uint64_t cdf = 0;
+        uint64_t cdfMin = 0;
+        for (int i = 0; i < 256; ++i) {
+            cdf += histogram[i];
+            if (cdfMin == 0) cdfMin = cdf;
+            float value = totalPixels > cdfMin
+                ? static_cast<float>(static_cast<double>(cdf - cdfMin) / (totalPixels - cdfMin))
+                : i / 255.0f;
+            lut[i] = glyphLevel(value);
+        }
+        return true;
     }
 
-    return edges;
+    // Auto-contrast: stretch the [clip, 1 - clip] percentile range to full scale
+    const uint64_t clip = static_cast<uint64_t>(kLevelsClip * totalPixels);
+    int lo = 0;
+    int hi = 255;
+    for (uint64_t seen = 0; lo < 255 && (seen += histogram[lo]) <= clip; ++lo) {
+    }
+    for (uint64_t seen = 0; hi > 0 && (seen += histogram[hi]) <= clip; --hi) {
+    }
+    if (hi <= lo) {
+        lo = 0;
+        hi = 255;
+    }
+    for (int i = 0; i < 256; ++i) {
+        float value = static_cast<float>(i - lo) / static_cast<float>(hi - lo);
+        value = std::max(0.0f, std::min(1.0f, value));
+        // Same gamma as the default mapping
+        lut[i] = glyphLevel(std::pow(value, 0.8f));
+    }
+    return true;
 }
 
 // ============================================================================
 // ASCII CONVERSION IMPLEMENTATION
 // ============================================================================
 
+// Normalized RGB of one pixel as fed to the HSV batch (gray replicated)
+static inline void hsvSource(const Image& img, int x, int y, float* dst) {
+    size_t idx = pixelBaseIndex(img, x, y);
+    float rf = img.data[idx] / 255.0f;
+    dst[0] = rf;
+    dst[1] = (img.channels > 1) ? (img.data[idx + 1] / 255.0f) : rf;
+    dst[2] = (img.channels > 2) ? (img.data[idx + 2] / 255.0f) : rf;
+}
+
+// Batch HSV conversion (assembly-accelerated when enabled)
+static void hsvBatch(const float* src, float* dst, int count) {
+    if (g_hsvAsm) {
+        rgbToHsvBatch(src, dst, count);
+    } else {
+        for (int p = 0; p < count; ++p) {
+            PixelHSV hsv = rgbToHsvCpp(src[p * 3 + 0], src[p * 3 + 1], src[p * 3 + 2]);
+            dst[p * 3 + 0] = hsv.h;
+            dst[p * 3 + 1] = hsv.s;
+            dst[p * 3 + 2] = hsv.v;
+        }
+    }
+}
+
+// Unquantized density level of a cell in [0, densityLevels - 1]: the HSV
+// value in HSV mode, else the pixel's luma through the gamma curve, or
+// through the levels table (interpolated between its 8-bit bins).
+static float rampValue(const Image& img, int x, int y, const float* hsv, const LevelsLut* levels) {
+    const float top = static_cast<float>(AsciiCharMap::densityLevels - 1);
+    if (hsv) {
+        // Use value from HSV as brightness instead
+        return std::max(0.0f, std::min(1.0f, hsv[2])) * top;
+    }
+
+    float luminance = getLuminance(img, x, y);
+    if (levels) {
+        float bin = std::max(0.0f, std::min(255.0f, luminance * 255.0f));
+        int lo = std::min(254, static_cast<int>(bin));
+        return (*levels)[lo] + (bin - lo) * ((*levels)[lo + 1] - (*levels)[lo]);
+    }
+
+    // Apply gamma correction for better contrast
+    luminance = std::pow(luminance, 0.8f);
+    // Clamp to [0, 1]
+    return std::max(0.0f, std::min(1.0f, luminance)) * top;
+}
+
+// Cell drawn with the given density level, then the HSV hue and edge
+// overrides. hueClass is set when the pixel falls in g_hueRule (HSV mode);
+// edges is null when edge characters are off.
+static AsciiPixel styledCell(const Image& img, int x, int y, int level, bool hueClass, const EdgeMap* edges) {
+    size_t idx = pixelBaseIndex(img, x, y);
+    unsigned char r = img.data[idx];
+    unsigned char g = (img.channels > 1) ? img.data[idx + 1] : r;
+    unsigned char b = (img.channels > 2) ? img.data[idx + 2] : r;
+
+    level = std::max(0, std::min(AsciiCharMap::densityLevels - 1, level));
+    char ch = AsciiCharMap::densityChars[level];
+
+    // Hue-based filtering: make the rule's hues prominent
+    if (hueClass) {
+        ch = '#';
+    }
+
+    // Override with edge character if applicable
+    if (edges) {
+        EdgeInfo edge = edges->getEdgeAt(x, y);
+        if (edge.magnitude > kEdgeThreshold) {
+            ch = AsciiCharMap::getEdgeChar(edge.angle);
+        }
+    }
+
+    return AsciiPixel{ch, r, g, b};
+}
+
+// Glyph and color of one cell; levels replaces the default gamma curve with a
+// per-image luma -> glyph level table (looked up by nearest bin).
+static AsciiPixel asciiCell(const Image& img, int x, int y, const float* hsv, const EdgeMap* edges,
+                            const LevelsLut* levels) {
+    int level = (levels && !hsv)
+        ? (*levels)[lumaBin(getLuminance(img, x, y))]
+        : static_cast<int>(rampValue(img, x, y, hsv, nullptr));
+    return styledCell(img, x, y, level, hsv && g_hueRule.matches(hsv[0], hsv[1]), edges);
+}
+
+// HSV mode's ramp position and hue class of one pixel from the lookup tables
+static inline float hsvLutLookup(const Image& img, int x, int y, const HsvLut& lut, bool& hueClass) {
+    size_t idx = pixelBaseIndex(img, x, y);
+    unsigned char r = img.data[idx];
+    unsigned char g = (img.channels > 1) ? img.data[idx + 1] : r;
+    unsigned char b = (img.channels > 2) ? img.data[idx + 2] : r;
+    hueClass = lut.hueClass[rgb565Index(r, g, b)] & kHueClassRule;
+    return lut.ramp[std::max({r, g, b})];
+}
+
+// asciiCell for HSV mode with the lookup tables
+static AsciiPixel lutCell(const Image& img, int x, int y, const HsvLut& lut, const EdgeMap* edges) {
+    bool hueClass;
+    int level = static_cast<int>(hsvLutLookup(img, x, y, lut, hueClass));
+    return styledCell(img, x, y, level, hueClass, edges);
+}
+
+// Error diffusion kernels: (dx, dy, share of the quantization error)
+struct DitherTap {
+    int dx, dy;
+    float weight;
+};
+static constexpr DitherTap kFloydSteinbergTaps[] = {
+    {1, 0, 7.0f / 16}, {-1, 1, 3.0f / 16}, {0, 1, 5.0f / 16}, {1, 1, 1.0f / 16},
+};
+// Atkinson spreads 6/8 of the error and drops the rest (less bleeding into flat areas)
+static constexpr DitherTap kAtkinsonTaps[] = {
+    {1, 0, 1.0f / 8}, {2, 0, 1.0f / 8}, {-1, 1, 1.0f / 8}, {0, 1, 1.0f / 8}, {1, 1, 1.0f / 8}, {0, 2, 1.0f / 8},
+};
+
+// How far a row trails the row above. A cell adds error up to two columns to
+// its right on its own row and one column to the right on the row below, so
+// with four columns of lag no error cell is ever updated by two rows at once
+// and each receives its contributions in serial (row-major) order.
+static constexpr int kDitherLag = 4;
+// Columns between progress updates (fewer atomic stores on the shared line)
+static constexpr int kDitherPublishCols = 16;
+
+// Error-diffused glyph levels over the whole grid as a diagonal wavefront:
+// worker t takes rows t, t + T, ... and starts column x of a row once the
+// row above has finished column x + kDitherLag - 1. The result is identical
+// to a serial pass for any thread count.
+static void ditherCells(const Image& img, const float* hsvDst, const HsvLut* lut, const EdgeMap* edges,
+                        const LevelsLut* levels, int threadCount, AsciiPixel* out) {
+    const int w = img.width;
+    const int h = img.height;
+    const DitherTap* taps = g_ditherMode == DitherMode::Atkinson ? kAtkinsonTaps : kFloydSteinbergTaps;
+    const int tapCount = g_ditherMode == DitherMode::Atkinson ? std::size(kAtkinsonTaps) : std::size(kFloydSteinbergTaps);
+
+    thread_local std::vector<float> errorScratch;
+    errorScratch.assign(static_cast<size_t>(w) * h, 0.0f);
+    float* error = errorScratch.data();
+    std::vector<std::atomic<int>> progress(h);  // finished columns per row
+
+    const float top = static_cast<float>(AsciiCharMap::densityLevels);
+    threadCount = std::max(1, std::min(threadCount, h));
+    forEachSobelWorker(threadCount, [&](int t) {
+        for (int y = t; y < h; y += threadCount) {
+            const std::atomic<int>* above = y > 0 ? &progress[y - 1] : nullptr;
+            int ready = above ? 0 : w;
+            AsciiPixel* row = out + static_cast<size_t>(y) * w;
+            const float* hsvRow = hsvDst ? hsvDst + static_cast<size_t>(y) * w * 3 : nullptr;
+
+            for (int x = 0; x < w; ++x) {
+                const int needed = std::min(w, x + kDitherLag);
+                while (ready < needed) {
+                    ready = above->load(std::memory_order_acquire);
+                    if (ready < needed) std::this_thread::yield();
+                }
+
+                // Level k stands for [k, k + 1); the clamp keeps the residual
+                // within half a level where the ramp saturates
+                const float* hsv = hsvRow ? hsvRow + x * 3 : nullptr;
+                float value;
+                bool hueClass;
+                if (lut) {
+                    value = hsvLutLookup(img, x, y, *lut, hueClass);
+                } else {
+                    value = rampValue(img, x, y, hsv, levels);
+                    hueClass = hsv && g_hueRule.matches(hsv[0], hsv[1]);
+                }
+                value += 0.5f + error[static_cast<size_t>(y) * w + x];
+                value = std::max(0.0f, std::min(top - 0.001f, value));
+                int level = static_cast<int>(value);
+                float residual = value - (level + 0.5f);
+                for (int i = 0; i < tapCount; ++i) {
+                    int nx = x + taps[i].dx;
+                    int ny = y + taps[i].dy;
+                    if (nx >= 0 && nx < w && ny < h) {
+                        error[static_cast<size_t>(ny) * w + nx] += residual * taps[i].weight;
+                    }
+                }
+
+                row[x] = styledCell(img, x, y, level, hueClass, edges);
+                if ((x + 1) % kDitherPublishCols == 0) progress[y].store(x + 1, std::memory_order_release);
+            }
+            progress[y].store(w, std::memory_order_release);
+        }
+    });
+}
+
+// Below this many cells per worker the glyph stage stays on fewer threads
+static constexpr size_t kAsciiCellsPerThread = 16 * 1024;
+
+// Run fn(begin, end) over [0, count) split into one range per worker; every
+// range except the first starts on a multiple of align
+template <typename Fn>
+static void forEachRange(size_t count, int threadCount, size_t align, Fn fn) {
+    if (count == 0) return;
+    forEachSobelWorker(threadCount, [&](int t) {
+        size_t begin = count * t / threadCount / align * align;
+        size_t end = (t + 1 == threadCount) ? count : count * (t + 1) / threadCount / align * align;
+        if (begin < end) fn(begin, end);
+    });
+}
+
+void convertToAscii(
+    const Image& scaledImg,
+    const EdgeMap* edges,
+    bool useEdges,
+    bool useHsv,
+    AsciiPixel* out
+) {
+    if (!scaledImg.isValid() || out == nullptr) {
+        return;
+    }
+
+    const int w = scaledImg.width;
+    const size_t totalPixels = static_cast<size_t>(w) * scaledImg.height;
+    const int threadCount = static_cast<int>(std::max<size_t>(1, std::min<size_t>(
+        static_cast<size_t>(resolveThreadCount()),
+        std::min<size_t>(scaledImg.height, totalPixels / kAsciiCellsPerThread))));
+
+    // HSV batch (uses ASM batch if g_hsvAsm). Ranges start on 4-pixel groups
+    // so the ASM vector/tail split hits every pixel as in one whole-frame batch.
+    // Scratch is kept per calling thread and reused across frames.
+    thread_local std::vector<float> hsvScratch;
+    const float* hsvDst = nullptr;
+    const HsvLut* lut = nullptr;
+    if (useHsv && g_hsvLut) {
+        // Levels and hue classes come straight from the tables: no HSV stage
+        lut = &hsvLut();
+        g_lastHsvMs = 0.0;
+    } else if (useHsv) {
+        hsvScratch.resize(totalPixels * 6);
+        float* src = hsvScratch.data();
+        float* dst = hsvScratch.data() + totalPixels * 3;
+        auto hsvStart = std::chrono::high_resolution_clock::now();
+        forEachRange(totalPixels, threadCount, 4, [&](size_t begin, size_t end) {
+            for (size_t p = begin; p < end; ++p) {
+                hsvSource(scaledImg, static_cast<int>(p % w), static_cast<int>(p / w), src + p * 3);
+            }
+            hsvBatch(src + begin * 3, dst + begin * 3, static_cast<int>(end - begin));
+        });
+        auto hsvEnd = std::chrono::high_resolution_clock::now();
+        g_lastHsvMs = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(hsvEnd - hsvStart).count();
+        hsvDst = dst;
+    } else {
+        g_lastHsvMs = std::nan("");
+    }
+
+    // The levels table maps luma; HSV mode draws from V, so it has no use for one
+    LevelsLut levelsLut;
+    const LevelsLut* levels = !useHsv && buildLevelsLut(scaledImg, g_levelsMode, levelsLut) ? &levelsLut : nullptr;
+
+    const EdgeMap* edgeSource = (useEdges && edges && edges->isValid()) ? edges : nullptr;
+    if (g_ditherMode != DitherMode::None) {
+        ditherCells(scaledImg, hsvDst, lut, edgeSource, levels, threadCount, out);
+        return;
+    }
+
+    // Every cell depends only on its own pixel, HSV entry and edge entry: split rows
+    forEachRange(static_cast<size_t>(scaledImg.height), threadCount, 1, [&](size_t y0, size_t y1) {
+        for (int y = static_cast<int>(y0); y < static_cast<int>(y1); ++y) {
+            AsciiPixel* row = out + static_cast<size_t>(y) * w;
+            if (lut) {
+                for (int x = 0; x < w; ++x) row[x] = lutCell(scaledImg, x, y, *lut, edgeSource);
+                continue;
+            }
+            const float* hsvRow = hsvDst ? hsvDst + static_cast<size_t>(y) * w * 3 : nullptr;
+            for (int x = 0; x < w; ++x) {
+                row[x] = asciiCell(scaledImg, x, y, hsvRow ? hsvRow + x * 3 : nullptr, edgeSource, levels);
+            }
+        }
+    });
+}
+
 std::vector<AsciiPixel> convertToAscii(
     const Image& scaledImg,
     const EdgeMap* edges,
@@ -310,98 +1030,227 @@ std::vector<AsciiPixel> convertToAscii(
     bool useHsv
 ) {
     std::vector<AsciiPixel> ascii;
-
     if (!scaledImg.isValid()) {
         return ascii;
     }
+    ascii.resize(static_cast<size_t>(scaledImg.width) * scaledImg.height);
+    convertToAscii(scaledImg, edges, useEdges, useHsv, ascii.data());
+    return ascii;
+}
 
-    ascii.reserve(scaledImg.width * scaledImg.height);
-
-    const int totalPixels = scaledImg.width * scaledImg.height;
+void convertToAsciiRegion(
+    const Image& scaledImg,
+    const EdgeMap* edges,
+    bool useEdges,
+    bool useHsv,
+    int x0,
+    int y0,
+    int x1,
+    int y1,
+    std::vector<AsciiPixel>& ascii,
+    const LevelsLut* levels
+) {
+    const int w = scaledImg.width;
+    const size_t totalPixels = static_cast<size_t>(w) * scaledImg.height;
+    if (!scaledImg.isValid() || ascii.size() != totalPixels) {
+        return;
+    }
+    x0 = std::max(0, x0);
+    y0 = std::max(0, y0);
+    x1 = std::min(w, x1);
+    y1 = std::min(scaledImg.height, y1);
+
+    const EdgeMap* edgeSource = (useEdges && edges && edges->isValid()) ? edges : nullptr;
+    if (useHsv && g_hsvLut) {
+        const HsvLut& lut = hsvLut();
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                ascii[static_cast<size_t>(y) * w + x] = lutCell(scaledImg, x, y, lut, edgeSource);
+            }
+        }
+        return;
+    }
 
-    // If HSV path requested, run batch conversion (uses ASM batch if g_useAsm)
+    std::vector<float> src;
     std::vector<float> hsvDst;
-    if (useHsv) {
-        hsvDst.resize(static_cast<size_t>(totalPixels) * 3);
-        std::vector<float> src;
-        src.reserve(static_cast<size_t>(totalPixels) * 3);
-        for (int y = 0; y < scaledImg.height; ++y) {
-            for (int x = 0; x < scaledImg.width; ++x) {
-                int idx = (y * scaledImg.width + x) * scaledImg.channels;
-                float rf = scaledImg.data[idx] / 255.0f;
-                float gf = (scaledImg.channels > 1) ? (scaledImg.data[idx + 1] / 255.0f) : rf;
-                float bf = (scaledImg.channels > 2) ? (scaledImg.data[idx + 2] / 255.0f) : rf;
-                src.push_back(rf);
-                src.push_back(gf);
-                src.push_back(bf);
+
+    for (int y = y0; y < y1; ++y) {
+        const size_t rowStart = static_cast<size_t>(y) * w;
+        size_t hsvStart = 0;
+        if (useHsv && x0 < x1) {
+            // Batch on the same 4-pixel groups as a whole-frame batch so the
+            // ASM vector/tail split hits every pixel the same way
+            hsvStart = (rowStart + x0) & ~static_cast<size_t>(3);
+            size_t hsvEnd = std::min(totalPixels, (rowStart + x1 + 3) & ~static_cast<size_t>(3));
+            size_t count = hsvEnd - hsvStart;
+            src.resize(count * 3);
+            hsvDst.resize(count * 3);
+            for (size_t p = 0; p < count; ++p) {
+                size_t pixel = hsvStart + p;
+                hsvSource(scaledImg, static_cast<int>(pixel % w), static_cast<int>(pixel / w), &src[p * 3]);
             }
+            hsvBatch(src.data(), hsvDst.data(), static_cast<int>(count));
         }
 
-        // Call batch HSV converter (assembly-accelerated when enabled)
-        auto hsvStart = std::chrono::high_resolution_clock::now();
-        rgbToHsvBatch(src.data(), hsvDst.data(), totalPixels);
-        auto hsvEnd = std::chrono::high_resolution_clock::now();
-        auto hsvMs = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(hsvEnd - hsvStart).count();
-        g_lastHsvMs = hsvMs;
+        for (int x = x0; x < x1; ++x) {
+            const float* hsv = useHsv ? &hsvDst[(rowStart + x - hsvStart) * 3] : nullptr;
+            ascii[rowStart + x] = asciiCell(scaledImg, x, y, hsv, edgeSource, levels);
+        }
     }
+}
 
-    if (!useHsv) {
-        g_lastHsvMs = std::nan("");
+// ============================================================================
+// STRUCTURE-AWARE GLYPHS
+// ============================================================================
+
+// Luma range (0-255) a cell needs before its shape is matched
+static constexpr int kStructureMinContrast = 48;
+// Largest Hamming distance (of 32 bits) accepted as a match; noisier cells keep their glyph
+static constexpr int kStructureMaxDistance = 8;
+// Entries of the per-thread mask -> glyph cache (power of two)
+static constexpr size_t kGlyphCacheSize = 4096;
+
+// Glyph at the smallest Hamming distance from mask, or 0 when none is within
+// kStructureMaxDistance. The distance is at least the difference in ink, so
+// only glyphs whose ink is within the cap (and then within the best distance
+// so far) are compared; ties go to the glyph with less ink.
+static char nearestGlyph(uint32_t mask) {
+    constexpr int kMaxInk = kGlyphCols * kGlyphRows;
+    const int ink = std::popcount(mask);
+    int best = kStructureMaxDistance + 1;
+    char ch = 0;
+    const int first = kGlyphInkStart[std::max(0, ink - kStructureMaxDistance)];
+    const int last = kGlyphInkStart[std::min(kMaxInk + 1, ink + kStructureMaxDistance + 1)];
+    for (int g = first; g < last; ++g) {
+        const GlyphMask& glyph = kGlyphMasks[g];
+        if (glyph.ink - ink >= best) break;
+        if (ink - glyph.ink >= best) continue;
+        int distance = std::popcount(glyph.bits ^ mask);
+        if (distance < best) {
+            best = distance;
+            ch = glyph.character;
+        }
+    }
+    return ch;
+}
+
+void matchGlyphStructure(const Image& source, int cols, int rows, AsciiPixel* out) {
+    g_lastStructureRatio = 0.0;
+    if (!source.isValid() || out == nullptr || cols <= 0 || rows <= 0) {
+        return;
     }
 
-    for (int y = 0; y < scaledImg.height; ++y) {
-        for (int x = 0; x < scaledImg.width; ++x) {
-            int idx = (y * scaledImg.width + x) * scaledImg.channels;
-            unsigned char r = scaledImg.data[idx];
-            unsigned char g = (scaledImg.channels > 1) ? scaledImg.data[idx + 1] : r;
-            unsigned char b = (scaledImg.channels > 2) ? scaledImg.data[idx + 2] : r;
-
-            float luminance = getLuminance(scaledImg, x, y);
-            // Apply gamma correction for better contrast
-            luminance = std::pow(luminance, 0.8f);
-            // Clamp to [0, 1]
-            luminance = std::max(0.0f, std::min(1.0f, luminance));
-
-            int level = static_cast<int>(luminance * (AsciiCharMap::densityLevels - 1));
-            level = std::max(0, std::min(AsciiCharMap::densityLevels - 1, level));
-
-            char ch = AsciiCharMap::densityChars[level];
-
-            // If HSV mode enabled, optionally override based on hue ranges
-            if (useHsv) {
-                int p = (y * scaledImg.width + x);
-                float h = hsvDst[p * 3 + 0];
-                float s = hsvDst[p * 3 + 1];
-                float v = hsvDst[p * 3 + 2];
-                // Use value from HSV as brightness instead
-                float hvLum = std::max(0.0f, std::min(1.0f, v));
-                int hvLevel = static_cast<int>(hvLum * (AsciiCharMap::densityLevels - 1));
-                hvLevel = std::max(0, std::min(AsciiCharMap::densityLevels - 1, hvLevel));
-                ch = AsciiCharMap::densityChars[hvLevel];
-
-                // Example hue-based filtering: make blue hues prominent
-                if (s > 0.15f && (h >= 180.0f && h <= 260.0f)) {
-                    ch = '#';
+    // Sample the source at the centre of each of the 4x8 sub-pixels of a cell.
+    // Point samples cost 32 reads per cell whatever the source size, and unlike
+    // scaleImage they never fall into its black right/bottom fill.
+    const int c = source.channels;
+    std::vector<uint32_t> sampleX(static_cast<size_t>(cols) * kGlyphCols);
+    for (size_t i = 0; i < sampleX.size(); ++i) {
+        int x = static_cast<int>((i + 0.5) * source.width / sampleX.size());
+        sampleX[i] = static_cast<uint32_t>(std::min(x, source.width - 1) * c);
+    }
+    // Colour samples are fetched as one 32-bit word (the pixel plus the next
+    // byte); the samples too close to the end of a row for that read bytewise
+    size_t wordSamples = sampleX.size();
+    if (c >= 3) {
+        const uint32_t rowBytes = static_cast<uint32_t>(source.width) * c;
+        while (wordSamples > 0 && sampleX[wordSamples - 1] + 4 > rowBytes) --wordSamples;
+    }
+    std::vector<int> sampleY(static_cast<size_t>(rows) * kGlyphRows);
+    for (size_t j = 0; j < sampleY.size(); ++j) {
+        sampleY[j] = std::min(static_cast<int>((j + 0.5) * source.height / sampleY.size()), source.height - 1);
+    }
+
+    const size_t cells = static_cast<size_t>(cols) * rows;
+    const int threadCount = static_cast<int>(std::max<size_t>(1, std::min<size_t>(
+        static_cast<size_t>(resolveThreadCount()),
+        std::min<size_t>(rows, cells * kGlyphCols * kGlyphRows / kAsciiCellsPerThread))));
+
+    std::atomic<size_t> matched{0};
+    forEachRange(static_cast<size_t>(rows), threadCount, 1, [&](size_t y0, size_t y1) {
+        // Masks repeat along straight edges, stripes and text: remember recent answers
+        struct CacheEntry {
+            uint32_t mask;
+            char ch;  // 0 = no glyph close enough
+            bool used;
+        };
+        thread_local std::array<CacheEntry, kGlyphCacheSize> cache{};
+
+        // One cell row of sub-pixel lumas, gathered source row by source row
+        // and stored cell-major: the 32 samples of a cell are contiguous
+        constexpr int kCellSamples = kGlyphCols * kGlyphRows;
+        std::vector<unsigned char> band(static_cast<size_t>(cols) * kCellSamples);
+        // Colour sources: the sampled pixels of a source row as 0x..BBGGRR words
+        // (little-endian targets) and their luma. Converting the packed row in
+        // one pass vectorizes, unlike a lumaByte per gathered pixel.
+        std::vector<uint32_t> rgbRow(c >= 3 ? sampleX.size() : 0);
+        std::vector<unsigned char> lumaRow(rgbRow.size());
+
+        size_t localMatched = 0;
+        for (int cy = static_cast<int>(y0); cy < static_cast<int>(y1); ++cy) {
+            for (int j = 0; j < kGlyphRows; ++j) {
+                const unsigned char* srcRow = source.row(sampleY[cy * kGlyphRows + j]);
+                unsigned char* dst = &band[j * kGlyphCols];
+                if (c >= 3) {
+                    const uint32_t* sx = sampleX.data();
+                    const size_t n = sampleX.size();
+                    uint32_t* packed = rgbRow.data();
+                    unsigned char* luma = lumaRow.data();
+                    for (size_t x = 0; x < wordSamples; ++x) {
+                        std::memcpy(&packed[x], srcRow + sx[x], sizeof(uint32_t));
+                    }
+                    for (size_t x = wordSamples; x < n; ++x) {
+                        const unsigned char* p = srcRow + sx[x];
+                        packed[x] = p[0] | (p[1] << 8) | (p[2] << 16);
+                    }
+                    for (size_t x = 0; x < n; ++x) {
+                        const uint32_t v = packed[x];
+                        luma[x] = lumaByte(v & 0xFF, (v >> 8) & 0xFF, (v >> 16) & 0xFF);
+                    }
+                    for (size_t x = 0; x < n; x += kGlyphCols, dst += kCellSamples) {
+                        std::memcpy(dst, luma + x, kGlyphCols);
+                    }
+                } else {
+                    for (size_t x = 0; x < sampleX.size(); x += kGlyphCols, dst += kCellSamples) {
+                        for (int i = 0; i < kGlyphCols; ++i) dst[i] = srcRow[sampleX[x + i]];
+                    }
                 }
             }
 
-            // Override with edge character if applicable
-            if (useEdges && edges && edges->isValid()) {
-                EdgeInfo edge = edges->getEdgeAt(x, y);
-                if (edge.magnitude > 0.25f) {
-                    ch = AsciiCharMap::getEdgeChar(edge.angle); 
+            for (int cx = 0; cx < cols; ++cx) {
+                const unsigned char* luma = &band[static_cast<size_t>(cx) * kCellSamples];
+                int sum = 0;
+                unsigned char lo = 255;
+                unsigned char hi = 0;
+                for (int k = 0; k < kCellSamples; ++k) {
+                    sum += luma[k];
+                    lo = std::min(lo, luma[k]);
+                    hi = std::max(hi, luma[k]);
                 }
-            }
+                if (hi - lo < kStructureMinContrast) continue;
 
-            AsciiPixel pixel{ch, r, g, b};
-            ascii.push_back(pixel);
-        }
-    }
+                // Ink where brighter than the mean (brighter = denser on the ramp)
+                uint32_t mask = 0;
+                for (int k = 0; k < kCellSamples; ++k) {
+                    mask |= static_cast<uint32_t>(luma[k] * kCellSamples > sum) << k;
+                }
 
-    return ascii;
+                CacheEntry& entry = cache[(mask * 0x9E3779B1u) >> 20 & (kGlyphCacheSize - 1)];
+                if (!entry.used || entry.mask != mask) {
+                    entry = CacheEntry{mask, nearestGlyph(mask), true};
+                }
+                if (entry.ch == 0) continue;
+                out[static_cast<size_t>(cy) * cols + cx].character = entry.ch;
+                ++localMatched;
+            }
+        }
+        matched.fetch_add(localMatched, std::memory_order_relaxed);
+    });
+    g_lastStructureRatio = static_cast<double>(matched.load()) / cells;
 }
 
-void printAsciiArt(
+void writeAsciiArt(
+    std::ostream& out,
     const std::vector<AsciiPixel>& ascii,
     int width,
     int height,
@@ -421,29 +1270,211 @@ void printAsciiArt(
             if (useColors) {
                 // Print with ANSI 24-bit true color support
                 // Format: \033[38;2;R;G;Bm (foreground color)
-                std::cout << "\033[38;2;"
-                          << static_cast<int>(pixel.r) << ";"
-                          << static_cast<int>(pixel.g) << ";"
-                          << static_cast<int>(pixel.b) << "m"
-                          << pixel.character;
+                out << "\033[38;2;"
+                    << static_cast<int>(pixel.r) << ";"
+                    << static_cast<int>(pixel.g) << ";"
+                    << static_cast<int>(pixel.b) << "m"
+                    << pixel.character;
             } else {
-                std::cout << pixel.character;
+                out << pixel.character;
             }
         }
 
         if (useColors) {
             // Reset color at end of line
-            std::cout << "\033[0m";
+            out << "\033[0m";
         }
 
-        std::cout << '\n';
+        out << '\n';
     }
 
     // Final color reset
     if (useColors) {
-        std::cout << "\033[0m";
+        out << "\033[0m";
+    }
+
+    out.flush();
+}
+
+void printAsciiArt(
+    const std::vector<AsciiPixel>& ascii,
+    int width,
+    int height,
+    bool useColors
+) {
+    writeAsciiArt(std::cout, ascii, width, height, useColors);
+}
+
+
+// ============================================================================
+// BRAILLE RENDERING IMPLEMENTATION
+// ============================================================================
+
+static constexpr int kBrailleDotCols = 2;
+static constexpr int kBrailleDotRows = 4;
+
+// Same pixel budget per worker as the glyph stage (8 pixels per cell)
+static constexpr size_t kBrailleCellsPerThread = kAsciiCellsPerThread / (kBrailleDotCols * kBrailleDotRows);
+
+// C++ version of the brailleDots kernel
+static void brailleDotsCpp(const unsigned char* levels, int rowStride, int cols, int threshold, unsigned char* out) {
+    static constexpr unsigned char kDotBits[kBrailleDotRows][kBrailleDotCols] = {
+        {0x01, 0x08}, {0x02, 0x10}, {0x04, 0x20}, {0x40, 0x80},
+    };
+    for (int x = 0; x < cols; ++x) {
+        unsigned char dots = 0;
+        for (int j = 0; j < kBrailleDotRows; ++j) {
+            const unsigned char* p = levels + static_cast<size_t>(j) * rowStride + x * kBrailleDotCols;
+            for (int i = 0; i < kBrailleDotCols; ++i) {
+                if (p[i] > threshold) dots |= kDotBits[j][i];
+            }
+        }
+        out[x] = dots;
+    }
+}
+
+static inline unsigned char pixelLumaByte(const unsigned char* p, int channels) {
+    return channels >= 3 ? lumaByte(p[0], p[1], p[2]) : p[0];
+}
+
+static int brailleThreadCount(size_t rows, size_t cells) {
+    return static_cast<int>(std::max<size_t>(1, std::min<size_t>(
+        static_cast<size_t>(resolveThreadCount()),
+        std::min<size_t>(rows, cells / kBrailleCellsPerThread))));
+}
+
+std::vector<BrailleCell> convertToBraille(const Image& scaledImg, const EdgeMap* edges) {
+    std::vector<BrailleCell> cells;
+    const int cols = scaledImg.isValid() ? scaledImg.width / kBrailleDotCols : 0;
+    const int rows = scaledImg.isValid() ? scaledImg.height / kBrailleDotRows : 0;
+    if (cols <= 0 || rows <= 0) {
+        return cells;
     }
+    cells.resize(static_cast<size_t>(cols) * rows);
+
+    const EdgeMap* edgeSource = (edges && edges->isValid() && edges->width == scaledImg.width
+                                 && edges->height == scaledImg.height) ? edges : nullptr;
+    const int c = scaledImg.channels;
+    const int stripWidth = cols * kBrailleDotCols;
+    const int threadCount = brailleThreadCount(rows, cells.size());
+
+    // Threshold at the mean luma of the dotted area
+    std::atomic<uint64_t> lumaSum{0};
+    forEachRange(static_cast<size_t>(rows) * kBrailleDotRows, threadCount, 1, [&](size_t y0, size_t y1) {
+        uint64_t sum = 0;
+        for (size_t y = y0; y < y1; ++y) {
+            const unsigned char* src = scaledImg.row(static_cast<int>(y));
+            for (int x = 0; x < stripWidth; ++x) sum += pixelLumaByte(src + x * c, c);
+        }
+        lumaSum.fetch_add(sum, std::memory_order_relaxed);
+    });
+    // Edge dots are forced to 255, which must stay above the threshold
+    const int threshold = static_cast<int>(std::min<uint64_t>(
+        254, lumaSum.load() / (static_cast<uint64_t>(stripWidth) * rows * kBrailleDotRows)));
+
+    forEachRange(static_cast<size_t>(rows), threadCount, 1, [&](size_t r0, size_t r1) {
+        std::vector<unsigned char> levels(static_cast<size_t>(stripWidth) * kBrailleDotRows);
+        std::vector<unsigned char> dots(cols);
+        for (int cy = static_cast<int>(r0); cy < static_cast<int>(r1); ++cy) {
+            // Luma of the cell row's four pixel rows; edge pixels always lit
+            for (int j = 0; j < kBrailleDotRows; ++j) {
+                const int y = cy * kBrailleDotRows + j;
+                const unsigned char* src = scaledImg.row(y);
+                unsigned char* dst = levels.data() + static_cast<size_t>(j) * stripWidth;
+                for (int x = 0; x < stripWidth; ++x) dst[x] = pixelLumaByte(src + x * c, c);
+                if (edgeSource) {
+                    const float* magnitudes = edgeSource->magnitudes + static_cast<size_t>(y) * edgeSource->width;
+                    for (int x = 0; x < stripWidth; ++x) {
+                        if (magnitudes[x] > kEdgeThreshold) dst[x] = 255;
+                    }
+                }
+            }
+
+            if (g_brailleAsm) {
+                brailleDots(levels.data(), stripWidth, cols, threshold, dots.data());
+            } else {
+                brailleDotsCpp(levels.data(), stripWidth, cols, threshold, dots.data());
+            }
+
+            BrailleCell* out = &cells[static_cast<size_t>(cy) * cols];
+            for (int cx = 0; cx < cols; ++cx) {
+                int sum[3] = {0, 0, 0};
+                for (int j = 0; j < kBrailleDotRows; ++j) {
+                    const unsigned char* p = scaledImg.row(cy * kBrailleDotRows + j) + cx * kBrailleDotCols * c;
+                    for (int i = 0; i < kBrailleDotCols; ++i, p += c) {
+                        for (int ch = 0; ch < 3; ++ch) sum[ch] += p[ch < c ? ch : 0];
+                    }
+                }
+                constexpr int n = kBrailleDotCols * kBrailleDotRows;
+                out[cx] = BrailleCell{dots[cx],
+                                      static_cast<unsigned char>((sum[0] + n / 2) / n),
+                                      static_cast<unsigned char>((sum[1] + n / 2) / n),
+                                      static_cast<unsigned char>((sum[2] + n / 2) / n)};
+            }
+        }
+    });
+    return cells;
+}
 
-    std::cout.flush();
+// UTF-8 of U+2800 + dots: E2, A0 | dots >> 6, 80 | (dots & 0x3F)
+struct BrailleUtf8 {
+    char bytes[3];
+};
+static constexpr std::array<BrailleUtf8, 256> kBrailleUtf8 = [] {
+    std::array<BrailleUtf8, 256> table{};
+    for (int dots = 0; dots < 256; ++dots) {
+        table[dots] = BrailleUtf8{{static_cast<char>(0xE2), static_cast<char>(0xA0 | (dots >> 6)),
+                                   static_cast<char>(0x80 | (dots & 0x3F))}};
+    }
+    return table;
+}();
+
+// Append "\033[38;2;R;G;Bm" without going through a stream
+static void appendAnsiColor(std::string& line, unsigned char r, unsigned char g, unsigned char b) {
+    char buffer[20];
+    int n = std::snprintf(buffer, sizeof(buffer), "\033[38;2;%u;%u;%um", r, g, b);
+    line.append(buffer, static_cast<size_t>(n));
 }
 
+void writeBrailleArt(
+    std::ostream& out,
+    const std::vector<BrailleCell>& cells,
+    int width,
+    int height,
+    bool useColors
+) {
+    if (width <= 0 || height <= 0 || cells.size() < static_cast<size_t>(width) * height) {
+        return;
+    }
+
+    // Each row is formatted on its own, so rows split across workers; a color
+    // escape is only emitted when the color changes along the row
+    std::vector<std::string> lines(height);
+    forEachRange(static_cast<size_t>(height), brailleThreadCount(height, cells.size()), 1, [&](size_t y0, size_t y1) {
+        for (size_t y = y0; y < y1; ++y) {
+            std::string& line = lines[y];
+            line.reserve(static_cast<size_t>(width) * (useColors ? 22 : 3) + 8);
+            const BrailleCell* row = &cells[y * width];
+            for (int x = 0; x < width; ++x) {
+                const BrailleCell& cell = row[x];
+                if (useColors && (x == 0 || cell.r != row[x - 1].r || cell.g != row[x - 1].g || cell.b != row[x - 1].b)) {
+                    appendAnsiColor(line, cell.r, cell.g, cell.b);
+                }
+                line.append(kBrailleUtf8[cell.dots].bytes, 3);
+            }
+            if (useColors) {
+                // Reset color at end of line
+                line += "\033[0m";
+            }
+            line += '\n';
+        }
+    });
+
+    for (const std::string& line : lines) {
+        out.write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+    if (useColors) {
+        out << "\033[0m";
+    }
+    out.flush();
+}
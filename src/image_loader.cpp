@@ -1,16 +1,51 @@
 // filepath: /Users/spacedesk2/CLionProjects/img-to-ascii/src/image_loader.cpp
 #include "../include/image_loader.h"
+#include "../include/buffer_pool.h"
+#include "../include/mem_stats.h"
+#include "../include/raw_loader.h"
+#include "../include/stream_loader.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <new>
+#include <vector>
 
 #define STB_IMAGE_IMPLEMENTATION
+// Decoder scratch and the pixels it returns show up under --mem-stats
+#define STBI_MALLOC(size) trackedMalloc(size)
+#define STBI_REALLOC(buffer, size) trackedRealloc(buffer, size)
+#define STBI_FREE(buffer) trackedFree(buffer)
 #include "../external/stb_image.h"
 
-Image::~Image() {
-    if (data != nullptr) {
-        stbi_image_free(data);
-        data = nullptr;
+void Image::release() {
+    if (data == nullptr) return;
+
+    size_t bytes = static_cast<size_t>(stride) * static_cast<size_t>(height);
+    switch (storage) {
+        case ImageStorage::Stb:
+            stbi_image_free(data);
+            break;
+        case ImageStorage::NewArray:
+            delete[] data;
+            break;
+        case ImageStorage::Pooled:
+            ImageBufferPool::instance().release(data, bytes);
+            break;
+        case ImageStorage::Aligned:
+            trackedFree(data);
+            break;
+        case ImageStorage::Borrowed:
+            break;  // owned by backing
     }
+    data = nullptr;
+    backing.reset();
+}
+
+Image::~Image() {
+    release();
 }
 
 Image::Image(Image&& other) noexcept
@@ -18,32 +53,137 @@ Image::Image(Image&& other) noexcept
     , width(other.width)
     , height(other.height)
     , channels(other.channels)
+    , stride(other.stride)
+    , storage(other.storage)
+    , backing(std::move(other.backing))
 {
     other.data = nullptr;
     other.width = 0;
     other.height = 0;
     other.channels = 0;
+    other.stride = 0;
 }
 
 Image& Image::operator=(Image&& other) noexcept {
     if (this != &other) {
-        if (data != nullptr) {
-            stbi_image_free(data);
-        }
+        release();
 
         data = other.data;
         width = other.width;
         height = other.height;
         channels = other.channels;
+        stride = other.stride;
+        storage = other.storage;
+        backing = std::move(other.backing);
 
         other.data = nullptr;
         other.width = 0;
         other.height = 0;
         other.channels = 0;
+        other.stride = 0;
     }
     return *this;
 }
 
+Image Image::allocate(int width, int height, int channels, ImageStorage storage) {
+    Image img;
+    if (width <= 0 || height <= 0 || channels <= 0) return img;
+
+    const size_t alignment = ImageBufferPool::kAlignment;
+    int rowBytes = width * channels;
+    int stride = rowBytes;
+    if (storage == ImageStorage::Aligned) {
+        // Pad every row so each one starts on a 64-byte boundary
+        stride = static_cast<int>((static_cast<size_t>(rowBytes) + alignment - 1) / alignment * alignment);
+    }
+    size_t bytes = static_cast<size_t>(stride) * static_cast<size_t>(height);
+
+    switch (storage) {
+        case ImageStorage::Stb:
+            img.data = static_cast<unsigned char*>(trackedMalloc(bytes));
+            break;
+        case ImageStorage::NewArray:
+            img.data = new (std::nothrow) unsigned char[bytes];
+            break;
+        case ImageStorage::Pooled:
+            img.data = static_cast<unsigned char*>(ImageBufferPool::instance().acquire(bytes));
+            break;
+        case ImageStorage::Aligned:
+            img.data = static_cast<unsigned char*>(
+                trackedAlignedAlloc(alignment, (bytes + alignment - 1) / alignment * alignment));
+            break;
+        case ImageStorage::Borrowed:
+            return img;  // borrowed images wrap existing memory, nothing to allocate
+    }
+
+    if (img.data == nullptr) return img;
+
+    img.width = width;
+    img.height = height;
+    img.channels = channels;
+    img.stride = stride;
+    img.storage = storage;
+    return img;
+}
+
+Image Image::borrow(const unsigned char* data, int width, int height, int channels, int stride,
+                    std::shared_ptr<const void> backing) {
+    Image img;
+    // Image::data is mutable for owned buffers; nothing writes through a Borrowed one
+    img.data = const_cast<unsigned char*>(data);
+    img.width = width;
+    img.height = height;
+    img.channels = channels;
+    img.stride = stride;
+    img.storage = ImageStorage::Borrowed;
+    img.backing = std::move(backing);
+    return img;
+}
+
+// Reduce a 3-channel (RGB) stb_image buffer to lumaByte in place
+static void reduceToLuma(Image& img) {
+    // Pixel i's luma lands at or before its RGB bytes
+    size_t pixels = static_cast<size_t>(img.width) * img.height;
+    for (size_t i = 0; i < pixels; ++i) {
+        const unsigned char* p = img.data + i * 3;
+        img.data[i] = lumaByte(p[0], p[1], p[2]);
+    }
+    if (void* shrunk = trackedRealloc(img.data, pixels)) {
+        img.data = static_cast<unsigned char*>(shrunk);
+    }
+    img.channels = 1;
+    img.stride = img.width;
+}
+
+// stb_image's own gray conversion uses other weights than getLuminance,
+// so a colour source is decoded as RGB and reduced to lumaByte afterwards:
+// its peak memory is still the full RGB buffer. Gray sources (1 or 2
+// components) are decoded straight to one plane, which is exact because
+// lumaByte(v, v, v) == v.
+static int stbChannels(int desiredChannels, int sourceChannels) {
+    if (desiredChannels != 1) return desiredChannels;
+    return sourceChannels == 1 || sourceChannels == 2 ? 1 : 3;
+}
+
+// Finish an Image whose data was just returned by stb_image for
+// stbChannels(desiredChannels, ...) == decodedChannels
+static void adoptStbBuffer(Image& img, int desiredChannels, int decodedChannels) {
+    img.storage = ImageStorage::Stb;
+    if (desiredChannels == 1) {
+        if (decodedChannels == 3) {
+            reduceToLuma(img);
+            return;
+        }
+        img.channels = 1;
+        img.stride = img.width;
+        return;
+    }
+    if (desiredChannels > 0) {
+        img.channels = desiredChannels;
+    }
+    img.stride = img.width * img.channels;
+}
+
 Image ImageLoader::loadImage(const std::string& filepath, int desiredChannels) {
     Image img;
 
@@ -52,17 +192,24 @@ Image ImageLoader::loadImage(const std::string& filepath, int desiredChannels) {
         return img;
     }
 
-    img.data = stbi_load(filepath.c_str(), &img.width, &img.height, &img.channels, desiredChannels);
+    // Uncompressed PNM/PAM/Y4M: map the file instead of going through stb_image
+    if (RawLoader::isRawFormat(filepath)) {
+        return RawLoader::loadImage(filepath, desiredChannels);
+    }
+
+    int sourceWidth = 0, sourceHeight = 0, sourceChannels = 0;
+    if (desiredChannels == 1 && !stbi_info(filepath.c_str(), &sourceWidth, &sourceHeight, &sourceChannels)) {
+        sourceChannels = 0;  // stbi_load below reports the error
+    }
+    const int decodedChannels = stbChannels(desiredChannels, sourceChannels);
+    img.data = stbi_load(filepath.c_str(), &img.width, &img.height, &img.channels, decodedChannels);
 
     if (img.data == nullptr) {
         std::cerr << "Błąd: Nie można wczytać obrazu: " << filepath << std::endl;
         std::cerr << "Powód: " << stbi_failure_reason() << std::endl;
         return img;
     }
-
-    if (desiredChannels > 0) {
-        img.channels = desiredChannels;
-    }
+    adoptStbBuffer(img, desiredChannels, decodedChannels);
 
     std::cout << "Obraz wczytany pomyślnie:" << std::endl;
     std::cout << "  Ścieżka: " << filepath << std::endl;
@@ -72,8 +219,320 @@ Image ImageLoader::loadImage(const std::string& filepath, int desiredChannels) {
     return img;
 }
 
+// ============================================================================
+// EMBEDDED THUMBNAILS
+// ============================================================================
+
+// A thumbnail must supply at least this many pixels per output cell on each
+// axis, and match the main image's aspect ratio within the tolerance
+// (cameras often letterbox thumbnails of non-4:3 photos to 160x120)
+static constexpr float kThumbnailMinScale = 1.0f;
+static constexpr float kThumbnailAspectTolerance = 0.02f;
+
+namespace {
+
+// Thumbnail payload: JPEG bytes, or a packed RGB raster when rgbWidth > 0
+struct ThumbnailSource {
+    std::vector<unsigned char> bytes;
+    int rgbWidth = 0;
+    int rgbHeight = 0;
+};
+
+// APP1 "Exif": the thumbnail is the JPEGInterchangeFormat(Length) pair of IFD1
+bool exifThumbnail(const std::vector<unsigned char>& segment, ThumbnailSource& out) {
+    if (segment.size() < 14 || std::memcmp(segment.data(), "Exif\0\0", 6) != 0) return false;
+    const unsigned char* tiff = segment.data() + 6;
+    const size_t size = segment.size() - 6;
+
+    bool little;
+    if (tiff[0] == 'I' && tiff[1] == 'I') {
+        little = true;
+    } else if (tiff[0] == 'M' && tiff[1] == 'M') {
+        little = false;
+    } else {
+        return false;
+    }
+    auto u16 = [&](size_t at) -> uint32_t {
+        return little ? tiff[at] | tiff[at + 1] << 8 : tiff[at] << 8 | tiff[at + 1];
+    };
+    auto u32 = [&](size_t at) -> uint32_t {
+        return little ? u16(at) | u16(at + 2) << 16 : u16(at) << 16 | u16(at + 2);
+    };
+    if (u16(2) != 42) return false;
+
+    // IFD0 only links to IFD1
+    size_t ifd = u32(4);
+    if (ifd + 2 > size) return false;
+    size_t next = ifd + 2 + static_cast<size_t>(u16(ifd)) * 12;
+    if (next + 4 > size) return false;
+    ifd = u32(next);
+    if (ifd == 0 || ifd + 2 > size) return false;
+    size_t count = u16(ifd);
+    if (ifd + 2 + count * 12 > size) return false;
+
+    uint32_t compression = 6;  // JPEG; some writers omit the tag
+    size_t offset = 0;
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t entry = ifd + 2 + i * 12;
+        uint32_t value = u16(entry + 2) == 3 ? u16(entry + 8) : u32(entry + 8);  // SHORT or LONG
+        switch (u16(entry)) {
+            case 0x0103: compression = value; break;
+            case 0x0201: offset = value; break;
+            case 0x0202: length = value; break;
+            default: break;
+        }
+    }
+    if (compression != 6 || length == 0 || offset > size || length > size - offset) return false;
+    out.bytes.assign(tiff + offset, tiff + offset + length);
+    return true;
+}
+
+// APP0 "JFIF" (raw RGB after the header) or "JFXX" extension (JPEG or raw RGB)
+bool jfifThumbnail(const std::vector<unsigned char>& segment, ThumbnailSource& out) {
+    size_t rgbAt;
+    if (segment.size() >= 14 && std::memcmp(segment.data(), "JFIF\0", 5) == 0) {
+        rgbAt = 12;
+    } else if (segment.size() >= 7 && std::memcmp(segment.data(), "JFXX\0", 5) == 0) {
+        if (segment[5] == 0x10) {
+            out.bytes.assign(segment.begin() + 6, segment.end());
+            return true;
+        }
+        if (segment[5] != 0x13) return false;  // 0x11 (palette) is not supported
+        rgbAt = 6;
+    } else {
+        return false;
+    }
+
+    int w = segment[rgbAt];
+    int h = segment.size() > rgbAt + 1 ? segment[rgbAt + 1] : 0;
+    size_t bytes = static_cast<size_t>(w) * h * 3;
+    if (w == 0 || h == 0 || segment.size() < rgbAt + 2 + bytes) return false;
+    out.bytes.assign(segment.begin() + rgbAt + 2, segment.begin() + rgbAt + 2 + bytes);
+    out.rgbWidth = w;
+    out.rgbHeight = h;
+    return true;
+}
+
+// Walk the JPEG markers up to the frame header, collecting the thumbnails of
+// APP0/APP1 and the main image size. Nothing past the SOF is read.
+bool scanJpegHeader(const std::string& filepath, std::vector<ThumbnailSource>& thumbnails, int& width, int& height) {
+    std::ifstream in(filepath, std::ios::binary);
+    if (in.get() != 0xFF || in.get() != 0xD8) return false;
+
+    std::vector<unsigned char> segment;
+    while (in) {
+        if (in.get() != 0xFF) return false;
+        int marker;
+        do {
+            marker = in.get();  // fill bytes
+        } while (marker == 0xFF);
+        if (marker == EOF || marker == 0xDA || marker == 0xD9) return false;  // scan or end before any SOF
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) continue;  // no payload
+
+        unsigned char lengthBytes[2];
+        if (!in.read(reinterpret_cast<char*>(lengthBytes), 2)) return false;
+        size_t length = static_cast<size_t>(lengthBytes[0] << 8 | lengthBytes[1]);
+        if (length < 2) return false;
+        length -= 2;
+
+        const bool isFrame = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (!isFrame && marker != 0xE0 && marker != 0xE1) {
+            in.seekg(static_cast<std::streamoff>(length), std::ios::cur);
+            continue;
+        }
+
+        segment.resize(length);
+        if (!in.read(reinterpret_cast<char*>(segment.data()), static_cast<std::streamsize>(length))) return false;
+        if (isFrame) {
+            if (length < 5) return false;
+            height = segment[1] << 8 | segment[2];
+            width = segment[3] << 8 | segment[4];
+            return width > 0 && height > 0;
+        }
+
+        ThumbnailSource thumbnail;
+        if (marker == 0xE0 ? jfifThumbnail(segment, thumbnail) : exifThumbnail(segment, thumbnail)) {
+            thumbnails.push_back(std::move(thumbnail));
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+Image ImageLoader::loadThumbnail(const std::string& filepath, int minWidth, int minHeight, int desiredChannels) {
+    Image img;
+
+    std::vector<ThumbnailSource> thumbnails;
+    int width = 0;
+    int height = 0;
+    if (!scanJpegHeader(filepath, thumbnails, width, height) || thumbnails.empty()) return img;
+
+    // Smallest thumbnail that is still good enough
+    const float aspect = static_cast<float>(width) / height;
+    const ThumbnailSource* best = nullptr;
+    int bestWidth = 0;
+    int bestHeight = 0;
+    for (const ThumbnailSource& thumbnail : thumbnails) {
+        int w = thumbnail.rgbWidth;
+        int h = thumbnail.rgbHeight;
+        int comp;
+        if (w == 0 && !stbi_info_from_memory(thumbnail.bytes.data(), static_cast<int>(thumbnail.bytes.size()),
+                                             &w, &h, &comp)) {
+            continue;
+        }
+        if (w < minWidth * kThumbnailMinScale || h < minHeight * kThumbnailMinScale) continue;
+        if (std::fabs(static_cast<float>(w) / h / aspect - 1.0f) > kThumbnailAspectTolerance) continue;
+        if (best == nullptr || static_cast<long>(w) * h < static_cast<long>(bestWidth) * bestHeight) {
+            best = &thumbnail;
+            bestWidth = w;
+            bestHeight = h;
+        }
+    }
+    if (best == nullptr) return img;
+
+    if (best->rgbWidth > 0) {
+        int outChannels = desiredChannels > 0 ? desiredChannels : 3;
+        img = Image::allocate(bestWidth, bestHeight, outChannels);
+        if (!img.isValid()) return img;
+        for (int y = 0; y < bestHeight; ++y) {
+            convertPixelRow(best->bytes.data() + static_cast<size_t>(y) * bestWidth * 3, 3, false,
+                            img.row(y), outChannels, bestWidth);
+        }
+    } else {
+        const int size = static_cast<int>(best->bytes.size());
+        int sourceWidth = 0, sourceHeight = 0, sourceChannels = 0;
+        if (desiredChannels == 1
+            && !stbi_info_from_memory(best->bytes.data(), size, &sourceWidth, &sourceHeight, &sourceChannels)) {
+            sourceChannels = 0;
+        }
+        const int decodedChannels = stbChannels(desiredChannels, sourceChannels);
+        img.data = stbi_load_from_memory(best->bytes.data(), size,
+                                         &img.width, &img.height, &img.channels, decodedChannels);
+        if (img.data == nullptr) {
+            std::cerr << "Błąd: Nie można zdekodować miniatury: " << filepath << std::endl;
+            return Image();
+        }
+        adoptStbBuffer(img, desiredChannels, decodedChannels);
+    }
+
+    std::cout << "Miniatura wczytana pomyślnie:" << std::endl;
+    std::cout << "  Ścieżka: " << filepath << std::endl;
+    std::cout << "  Wymiary: " << img.width << "x" << img.height << " (obraz: " << width << "x" << height << ")" << std::endl;
+    std::cout << "  Kanały: " << img.channels << std::endl;
+
+    return img;
+}
+
 bool ImageLoader::fileExists(const std::string& filepath) {
     std::ifstream file(filepath);
     return file.good();
 }
 
+
+// ============================================================================
+// ANIMATED GIF
+// ============================================================================
+
+// Browsers show frames with no (or a very short) delay for 100 ms
+static constexpr int kGifMinDelayMs = 20;
+static constexpr int kGifDefaultDelayMs = 100;
+
+struct GifReader::State {
+    std::shared_ptr<MappedFile> file;
+    stbi__context context{};
+    stbi__gif gif{};
+    // Composited frames k-1 and k-2: "restore to previous" disposal reads k-2
+    std::vector<stbi_uc> previous;
+    std::vector<stbi_uc> twoBack;
+    int frames = 0;
+    bool finished = false;
+    bool failed = false;
+
+    ~State() {
+        STBI_FREE(gif.out);
+        STBI_FREE(gif.background);
+        STBI_FREE(gif.history);
+    }
+};
+
+GifReader::GifReader() = default;
+GifReader::~GifReader() = default;
+
+bool GifReader::isGif(const std::string& filepath) {
+    std::ifstream file(filepath, std::ios::binary);
+    char magic[4] = {};
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, "GIF8", 4) == 0;
+}
+
+bool GifReader::open(const std::string& filepath) {
+    state.reset();
+    auto s = std::make_unique<State>();
+    s->file = MappedFile::open(filepath);
+    if (!s->file || s->file->size() > static_cast<size_t>(INT32_MAX)) return false;
+
+    stbi__start_mem(&s->context, s->file->data(), static_cast<int>(s->file->size()));
+    if (!stbi__gif_test(&s->context)) return false;  // rewinds on success
+    state = std::move(s);
+    return true;
+}
+
+bool GifReader::failed() const {
+    return !state || state->failed;
+}
+
+int GifReader::framesDecoded() const {
+    return state ? state->frames : 0;
+}
+
+bool GifReader::next(Image& frame, int& delayMs, int desiredChannels) {
+    if (!state || state->finished) return false;
+    State& s = *state;
+
+    int comp = 0;
+    stbi_uc* twoBack = s.twoBack.empty() ? nullptr : s.twoBack.data();
+    stbi_uc* out = stbi__gif_load_next(&s.context, &s.gif, &comp, 4, twoBack);
+    if (out == nullptr || out == reinterpret_cast<stbi_uc*>(&s.context)) {
+        // Null is an error unless at least one frame came before a truncated trailer
+        s.finished = true;
+        if (out == nullptr && s.frames == 0) {
+            s.failed = true;
+            std::cerr << "Błąd: Nie można zdekodować GIF-a: " << stbi_failure_reason() << std::endl;
+        }
+        return false;
+    }
+
+    const int w = s.gif.w;
+    const int h = s.gif.h;
+    const size_t pixels = static_cast<size_t>(w) * h;
+    s.twoBack.swap(s.previous);
+    s.previous.assign(out, out + pixels * 4);
+    ++s.frames;
+
+    const int channels = desiredChannels == 1 || desiredChannels == 3 ? desiredChannels : 4;
+    frame = Image::allocate(w, h, channels);
+    if (!frame.isValid()) {
+        s.finished = true;
+        s.failed = true;
+        return false;
+    }
+    for (int y = 0; y < h; ++y) {
+        const stbi_uc* src = out + static_cast<size_t>(y) * w * 4;
+        unsigned char* dst = frame.row(y);
+        if (channels == 4) {
+            std::memcpy(dst, src, static_cast<size_t>(w) * 4);
+        } else if (channels == 3) {
+            for (int x = 0; x < w; ++x) {
+                dst[x * 3 + 0] = src[x * 4 + 0];
+                dst[x * 3 + 1] = src[x * 4 + 1];
+                dst[x * 3 + 2] = src[x * 4 + 2];
+            }
+        } else {
+            for (int x = 0; x < w; ++x) dst[x] = lumaByte(src[x * 4], src[x * 4 + 1], src[x * 4 + 2]);
+        }
+    }
+
+    delayMs = s.gif.delay < kGifMinDelayMs ? kGifDefaultDelayMs : s.gif.delay;
+    return true;
+}
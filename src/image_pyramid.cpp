@@ -0,0 +1,106 @@
+#include "../include/image_pyramid.h"
+#include "../include/image_converter.h"
+#include <algorithm>
+#include <thread>
+
+// ============================================================================
+// 2x BOX DOWNSAMPLE
+// ============================================================================
+
+// Average the source block [2x, 2x+spanX) x [2y, 2y+spanY) for rows [startY, endY)
+static void downsampleRows(const Image& src, Image& dst, int startY, int endY) {
+    const int c = src.channels;
+
+    for (int y = startY; y < endY; ++y) {
+        int sy = y * 2;
+        // Last output row absorbs a leftover odd source row
+        int spanY = (y == dst.height - 1) ? src.height - sy : 2;
+
+        for (int x = 0; x < dst.width; ++x) {
+            int sx = x * 2;
+            int spanX = (x == dst.width - 1) ? src.width - sx : 2;
+            int count = spanX * spanY;
+
+            for (int ch = 0; ch < c; ++ch) {
+                int sum = 0;
+                for (int dy = 0; dy < spanY; ++dy) {
+                    const unsigned char* p = src.row(sy + dy) + sx * c + ch;
+                    for (int dx = 0; dx < spanX; ++dx) {
+                        sum += p[dx * c];
+                    }
+                }
+                dst.row(y)[x * c + ch] = static_cast<unsigned char>((sum + count / 2) / count);
+            }
+        }
+    }
+}
+
+Image downsample2x(const Image& src) {
+    if (!src.isValid() || src.width < 2 || src.height < 2) {
+        return Image();
+    }
+
+    Image dst = Image::allocate(src.width / 2, src.height / 2, src.channels);
+    if (!dst.isValid()) {
+        return dst;
+    }
+
+    int threadCount = std::min(resolveThreadCount(), dst.height);
+    if (threadCount <= 1) {
+        downsampleRows(src, dst, 0, dst.height);
+        return dst;
+    }
+
+    int block = (dst.height + threadCount - 1) / threadCount;
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (int t = 0; t < threadCount; ++t) {
+        int s = t * block;
+        int e = std::min(dst.height, s + block);
+        if (s >= e) break;
+        workers.emplace_back([&src, &dst, s, e]() {
+            downsampleRows(src, dst, s, e);
+        });
+    }
+    for (auto& th : workers) th.join();
+
+    return dst;
+}
+
+// ============================================================================
+// PYRAMID
+// ============================================================================
+
+ImagePyramid buildPyramid(Image&& base, int minWidth, int minHeight) {
+    ImagePyramid pyramid;
+    if (!base.isValid()) {
+        return pyramid;
+    }
+
+    pyramid.levels.push_back(std::move(base));
+
+    while (true) {
+        const Image& top = pyramid.levels.back();
+        if (top.width / 2 < minWidth || top.height / 2 < minHeight) break;
+
+        Image next = downsample2x(top);
+        if (!next.isValid()) break;
+        pyramid.levels.push_back(std::move(next));
+    }
+
+    return pyramid;
+}
+
+int ImagePyramid::levelIndexFor(int targetWidth, int targetHeight) const {
+    int best = 0;
+    for (int i = 0; i < static_cast<int>(levels.size()); ++i) {
+        if (levels[i].width >= targetWidth && levels[i].height >= targetHeight) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+const Image& ImagePyramid::levelFor(int targetWidth, int targetHeight) const {
+    return levels[levelIndexFor(targetWidth, targetHeight)];
+}
@@ -1,8 +1,28 @@
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <sstream>
+#include <utility>
+#include <vector>
 #include "../include/image_loader.h"
+#include "../include/ascii_archive.h"
+#include "../include/sequence_converter.h"
+#include "../include/ascii_export.h"
+#include "../include/auto_tuner.h"
+#include "../include/buffer_pool.h"
+#include "../include/frame_pipeline.h"
+#include "../include/glyph_masks.h"
 #include "../include/image_converter.h"
+#include "../include/image_pyramid.h"
+#include "../include/mem_stats.h"
+#include "../include/raw_loader.h"
+#include "../include/stream_loader.h"
+#include "../include/terminal_viewer.h"
+#include "../include/watch_mode.h"
 
 extern "C" {
     int add(int a, int b);
@@ -13,9 +33,44 @@ extern "C" {
 bool g_sobelAsm = false;
 bool g_hsvAsm = false;
 
+// Braille dot packing; opt-in like the other kernels until the NEON kernel has
+// been compared with the C++ packer on ARM64 hardware
+bool g_brailleAsm = false;
+
+// Skip Sobel on tiles too flat to hold an edge (output is unchanged)
+bool g_sobelFlatSkip = true;
+
+// Decode to a single luma plane when neither colors nor HSV are used
+bool g_grayFastPath = true;
+
+// Edge detector and Canny hysteresis thresholds (normalized magnitude)
+EdgeMode g_edgeMode = EdgeMode::Sobel;
+float g_cannyLow = 0.1f;
+float g_cannyHigh = 0.25f;
+
+// Luma -> glyph mapping (fixed curve, auto-contrast or equalization)
+LevelsMode g_levelsMode = LevelsMode::Off;
+
+// Error diffusion over the glyph ramp
+DitherMode g_ditherMode = DitherMode::None;
+
+// HSV mode's hue override, and whether HSV reads lookup tables instead of
+// converting every pixel (hue classes are approximate, so opt-in)
+HueRule g_hueRule;
+bool g_hsvLut = false;
+
+// Glyph choice: brightness ramp only, or shape matching on contrasted cells
+GlyphMode g_glyphMode = GlyphMode::Density;
+
+// Per-stage allocation counts and RSS as METRIC lines (replaces operator new; opt-in)
+bool g_memStats = false;
+
 // Global thread count for processing (0 = auto). Clamped to [1,64] when used.
 int g_threadCount = 0;
 
+// Sobel stage thread count picked by --auto (0 = follow g_threadCount)
+int g_sobelThreadCount = 0;
+
 // C++ implementation of add function
 int addCpp(int a, int b) {
     return a + b;
@@ -34,15 +89,55 @@ void printUsage(const char* programName) {
     std::cout << "  --width <cols>   Target ASCII art width (default: 120)" << std::endl;
     std::cout << "  --height <rows>  Target ASCII art height (default: 60)" << std::endl;
     std::cout << "  --edges          Enable edge detection" << std::endl;
+    std::cout << "  --edges=canny    Edge detection with thin Canny edges (--edges=sobel is the default)" << std::endl;
+    std::cout << "  --canny-low <t>  Canny weak threshold on normalized magnitude (default: 0.1)" << std::endl;
+    std::cout << "  --canny-high <t> Canny strong threshold on normalized magnitude (default: 0.25)" << std::endl;
     std::cout << "  --no-edges       Disable edge detection" << std::endl;
+    std::cout << "  --levels <mode>  Brightness mapping: off (default), auto (auto-contrast) or equalize (not with --hsv)" << std::endl;
+    std::cout << "  --dither <mode>  Error diffusion over the glyph ramp: none (default), fs (Floyd-Steinberg) or atkinson" << std::endl;
+    std::cout << "  --mode <mode>    Output: ascii (default) or braille (2x4 dots per cell, U+2800 block)" << std::endl;
+    std::cout << "  --braille-asm    Pack braille dots with the assembly kernel (default: C++)" << std::endl;
+    std::cout << "  --no-braille-asm Pack braille dots in C++" << std::endl;
+    std::cout << "  --glyphs <mode>  Glyph choice: density (default) or structure (match 4x8 cell shapes)" << std::endl;
     std::cout << "  --colors         Enable ANSI 24-bit true color output" << std::endl;
     std::cout << "  --no-colors      Disable ANSI colors" << std::endl;
+    std::cout << "  --rgb            Decode RGB even when colors and HSV are off (default: luma only)" << std::endl;
     std::cout << "  --sobel-asm      Use assembly implementation for Sobel (alias: --sobel-asm)" << std::endl;
     std::cout << "  --no-sobel-asm   Disable assembly Sobel (alias: --no-sobel-asm)" << std::endl;
+    std::cout << "  --no-flat-skip   Run Sobel on every tile, including flat ones" << std::endl;
     std::cout << "  --hsv-asm        Use assembly implementation for HSV batch (alias: --hsv-asm)" << std::endl;
     std::cout << "  --no-hsv-asm     Disable assembly HSV batch (alias: --no-hsv-asm)" << std::endl;
     std::cout << "  --hsv            Use RGB->HSV batch conversion and hue-based filtering (also enables --hsv-asm by default)" << std::endl;
     std::cout << "  --no-hsv         Disable HSV conversion and disable HSV ASM" << std::endl;
+    std::cout << "  --hsv-lut        HSV mode without the HSV pass: hue classes from an RGB565 table (approximate at hue boundaries)" << std::endl;
+    std::cout << "  --hue-range <a-b> Hues drawn as '#' in HSV mode, in degrees; wraps when a > b (default: 180-260)" << std::endl;
+    std::cout << "  --hue-saturation <s> Minimum saturation for the hue override (default: 0.15)" << std::endl;
+    std::cout << "  --stream         Decode PPM/PGM/BMP row by row straight into the scaler" << std::endl;
+    std::cout << "  --max-memory <MB> Peak ingest memory cap; larger inputs are streamed or rejected" << std::endl;
+    std::cout << "  --full-decode    Always decode the main image, never an embedded JPEG thumbnail" << std::endl;
+    std::cout << "  --mem-stats      Count allocations, heap peak and RSS per pipeline stage (METRIC:Mem_* lines);\n"
+              << "                   luma-only runs of colour images still peak at the RGB decode size in Load" << std::endl;
+    std::cout << "  --sizes <list>   Render several sizes from one decode, e.g. 80x30,120x60 (or 'presets')" << std::endl;
+    std::cout << "  --view           Interactive pan/zoom viewer (arrows/hjkl pan, +/- zoom, q quit)" << std::endl;
+    std::cout << "  --tune           Benchmark Sobel/HSV backends and thread counts on this host, write profile" << std::endl;
+    std::cout << "  --auto           Pick Sobel/HSV backend and threads from the tuning profile" << std::endl;
+    std::cout << "  --profile <path> Tuning profile location (default: img_to_ascii.tune)" << std::endl;
+    std::cout << "  --dump <file>    Also save the converted grid as a one-frame .a2a archive" << std::endl;
+    std::cout << "  --diff <file>    Compare <image_path> (.a2a) against another archive; non-zero exit on mismatch" << std::endl;
+    std::cout << "  --tolerance <r>  Max fraction of differing glyphs for --diff (default: 0)" << std::endl;
+    std::cout << "  --color-tolerance <n> Max per-channel color difference for --diff (default: 0)" << std::endl;
+    std::cout << "  --format <fmt>   Output format: ansi (default), html or svg" << std::endl;
+    std::cout << "  --output <file>  File for html/svg output (required with --format html/svg)" << std::endl;
+    std::cout << "  --quantize <bits> Drop low color bits (0-7) so more html/svg color runs merge" << std::endl;
+    std::cout << "  --watch <dir>    Convert every image written into <dir> (inotify); <image_path> is ignored" << std::endl;
+    std::cout << "  --out-dir <dir>  Output directory for --watch (default: next to the input)" << std::endl;
+    std::cout << "  --watch-workers <n> Converter threads for --watch (default: half the hardware threads)" << std::endl;
+    std::cout << "  --watch-limit <n> Exit after converting n files" << std::endl;
+    std::cout << "  --archive <file> Write the converted frame(s) to a compact .a2a archive (all frames for Y4M and GIF)" << std::endl;
+    std::cout << "  --no-temporal    Recompute every frame of a sequence in full (no dirty-tile reuse)" << std::endl;
+    std::cout << "  --play           Play back an .a2a archive, or convert and play an animated GIF at its own timing" << std::endl;
+    std::cout << "  --fps <n>        Playback rate for --play (default: stored frame times, else 12; 0 = unthrottled)" << std::endl;
+    std::cout << "  --frame <n>      Show only frame n of the archive" << std::endl;
     std::cout << std::endl;
     std::cout << "Recommended sizes for different terminals:" << std::endl;
     std::cout << "  Small:  80x30   (fits in small terminals)" << std::endl;
@@ -57,9 +152,504 @@ void printUsage(const char* programName) {
     std::cout << "  " << programName << " image.jpg --colors" << std::endl;
     std::cout << "  " << programName << " image.jpg --no-colors" << std::endl;
     std::cout << "  " << programName << " image.jpg --no-sobel-asm --no-hsv-asm" << std::endl;
+    std::cout << "  " << programName << " image.jpg --sizes presets" << std::endl;
+    std::cout << "  " << programName << " image.jpg --tune" << std::endl;
+    std::cout << "  " << programName << " image.jpg --edges --hsv --colors --auto" << std::endl;
+    std::cout << "  " << programName << " image.jpg --edges --no-hsv --no-sobel-asm --colors --format html --output art.html" << std::endl;
+    std::cout << "  " << programName << " - --edges --no-hsv --no-sobel-asm --no-colors --watch spool/ --out-dir ascii/" << std::endl;
+    std::cout << "  " << programName << " clip.y4m --edges --no-hsv --no-sobel-asm --colors --archive clip.a2a" << std::endl;
+    std::cout << "  " << programName << " clip.a2a --play --fps 24" << std::endl;
+    std::cout << "  " << programName << " anim.gif --edges --no-hsv --no-sobel-asm --colors --play" << std::endl;
     std::cout << std::endl;
 }
 
+// Parse "80x30,120x60,..." (or "presets" for the recommended sizes above)
+static bool parseSizeList(const std::string& list, std::vector<std::pair<int, int>>& sizes) {
+    if (list == "presets") {
+        sizes = {{80, 30}, {120, 60}, {160, 80}, {200, 100}};
+        return true;
+    }
+
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t x = item.find('x');
+        if (x == std::string::npos) return false;
+        try {
+            int w = std::stoi(item.substr(0, x));
+            int h = std::stoi(item.substr(x + 1));
+            if (w <= 0 || h <= 0) return false;
+            sizes.emplace_back(w, h);
+        } catch (...) {
+            return false;
+        }
+    }
+    return !sizes.empty();
+}
+
+// Multi-size mode: one decode, one pyramid, one scale/edges/ASCII pass per size
+static int runMultiSize(
+    const std::string& imagePath,
+    const std::vector<std::pair<int, int>>& sizes,
+    bool useEdges,
+    bool useHsv,
+    bool useColors,
+    bool noRender
+) {
+    auto totalStart = std::chrono::high_resolution_clock::now();
+
+    std::cout << "[1/3] Loading image..." << std::endl;
+    Image originalImg = ImageLoader::loadImage(imagePath, pipelineChannels(useColors, useHsv));
+    if (!originalImg.isValid()) {
+        std::cerr << "[ERROR] Failed to load image!" << std::endl;
+        return 1;
+    }
+
+    // Build down to the smallest requested output, so every size is bilinear-scaled
+    // from a level less than 2x its size instead of one large, aliasing step
+    int minWidth = sizes.front().first;
+    int minHeight = static_cast<int>(sizes.front().second * 0.75f);
+    for (const auto& [w, h] : sizes) {
+        minWidth = std::min(minWidth, w);
+        minHeight = std::min(minHeight, static_cast<int>(h * 0.75f));
+    }
+
+    std::cout << "[2/3] Building image pyramid..." << std::endl;
+    auto pyramidStart = std::chrono::high_resolution_clock::now();
+    ImagePyramid pyramid = buildPyramid(std::move(originalImg), minWidth, minHeight);
+    auto pyramidEnd = std::chrono::high_resolution_clock::now();
+    double pyramidMs = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(pyramidEnd - pyramidStart).count();
+
+    std::cout << "[✓] Pyramid levels: " << pyramid.levels.size() << std::endl;
+    for (const Image& level : pyramid.levels) {
+        std::cout << "    " << level.width << "x" << level.height << std::endl;
+    }
+    std::cout << std::endl;
+
+    std::cout << "[3/3] Rendering " << sizes.size() << " sizes..." << std::endl;
+    std::vector<double> sizeMs;
+    for (const auto& [targetWidth, targetHeight] : sizes) {
+        auto sizeStart = std::chrono::high_resolution_clock::now();
+
+        // Same terminal aspect compensation as the single-size path
+        int adjustedHeight = static_cast<int>(targetHeight * 0.75f);
+        const Image& level = pyramid.levelFor(targetWidth, adjustedHeight);
+        Image scaledImg = scaleImage(level, targetWidth, adjustedHeight, 1.0f);
+        if (!scaledImg.isValid()) {
+            std::cerr << "[ERROR] Failed to scale image to " << targetWidth << "x" << targetHeight << std::endl;
+            return 1;
+        }
+
+        EdgeMap* edges = nullptr;
+        if (useEdges) {
+            edges = new EdgeMap(detectEdges(scaledImg));
+        }
+        std::vector<AsciiPixel> asciiArt = convertToAscii(scaledImg, edges, useEdges, useHsv);
+        delete edges;
+        if (g_glyphMode == GlyphMode::Structure) {
+            // Shape matching needs kGlyphCols x kGlyphRows pixels per cell
+            const Image& detail = pyramid.levelFor(targetWidth * kGlyphCols, adjustedHeight * kGlyphRows);
+            matchGlyphStructure(detail, scaledImg.width, scaledImg.height, asciiArt.data());
+        }
+
+        sizeMs.push_back(std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+            std::chrono::high_resolution_clock::now() - sizeStart).count());
+
+        if (!noRender) {
+            std::cout << "==================================================" << std::endl;
+            std::cout << "  " << targetWidth << "x" << targetHeight
+                      << " (from level " << pyramid.levelIndexFor(targetWidth, adjustedHeight)
+                      << ": " << level.width << "x" << level.height << ")" << std::endl;
+            std::cout << "==================================================" << std::endl;
+            printAsciiArt(asciiArt, scaledImg.width, scaledImg.height, useColors);
+            std::cout << std::endl;
+        }
+    }
+
+    double totalTimeMs = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+        std::chrono::high_resolution_clock::now() - totalStart).count();
+
+    std::cout << "[✓] Conversion completed successfully!" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Performance Summary:" << std::endl;
+    std::cout << "  TOTAL: " << totalTimeMs << " ms" << std::endl;
+    std::cout << std::endl;
+
+    printf("METRIC:Pyramid_ms:%.6f\n", pyramidMs);
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        printf("METRIC:Size_%dx%d_ms:%.6f\n", sizes[i].first, sizes[i].second, sizeMs[i]);
+    }
+    printf("METRIC:BufferPool_hits:%zu\n", ImageBufferPool::instance().hits());
+    printf("METRIC:BufferPool_misses:%zu\n", ImageBufferPool::instance().misses());
+    printf("METRIC:TOTAL_ms:%.6f\n", totalTimeMs);
+    printMemStats();
+    return 0;
+}
+
+// Convert one frame through the regular scale -> edges -> ASCII pipeline.
+// The grid is resized in place, so a caller reusing it across frames does not reallocate.
+static bool convertFrame(
+    const Image& frame,
+    int targetWidth,
+    int adjustedHeight,
+    bool useEdges,
+    bool useHsv,
+    std::vector<AsciiPixel>& ascii,
+    int& outWidth,
+    int& outHeight
+) {
+    Image scaledImg = scaleImage(frame, targetWidth, adjustedHeight, 1.0f);
+    if (!scaledImg.isValid()) return false;
+    outWidth = scaledImg.width;
+    outHeight = scaledImg.height;
+    ascii.resize(static_cast<size_t>(outWidth) * outHeight);
+
+    if (!useEdges) {
+        convertToAscii(scaledImg, nullptr, false, useHsv, ascii.data());
+    } else {
+        EdgeMap edges = detectEdges(scaledImg);
+        convertToAscii(scaledImg, &edges, true, useHsv, ascii.data());
+    }
+    if (g_glyphMode == GlyphMode::Structure) {
+        matchGlyphStructure(frame, outWidth, outHeight, ascii.data());
+    }
+    return true;
+}
+
+// Archive mode: convert every frame (Y4M) or the single image and append to an .a2a file
+static int runArchive(
+    const std::string& imagePath,
+    const std::string& archivePath,
+    int targetWidth,
+    int adjustedHeight,
+    bool useEdges,
+    bool useHsv,
+    bool useColors,
+    bool temporalReuse
+) {
+    auto totalStart = std::chrono::high_resolution_clock::now();
+
+    Y4mReader sequence;
+    bool isSequence = sequence.open(imagePath);
+    int frameCount = isSequence ? sequence.frameCount() : 1;
+
+    // Consecutive frames only recompute the tiles that changed. Shape matching
+    // reads the full-resolution frame, which the tile cache does not track.
+    SequenceConverter temporal(targetWidth, adjustedHeight, useEdges, useHsv);
+    temporalReuse = temporalReuse && isSequence && g_glyphMode == GlyphMode::Density;
+    double convertMs = 0.0;
+
+    AsciiArchiveWriter writer;
+    bool opened = false;
+    std::vector<AsciiPixel> converted;
+    const int channels = pipelineChannels(useColors, useHsv);
+
+    std::cout << "[1/2] Converting " << frameCount << " frame(s)..." << std::endl;
+    for (int i = 0; i < frameCount; ++i) {
+        Image frame = isSequence ? sequence.frame(i, channels) : ImageLoader::loadImage(imagePath, channels);
+        if (!frame.isValid()) {
+            std::cerr << "[ERROR] Failed to load frame " << i << std::endl;
+            return 1;
+        }
+
+        auto convertStart = std::chrono::high_resolution_clock::now();
+        int w = 0, h = 0;
+        if (!temporalReuse && !convertFrame(frame, targetWidth, adjustedHeight, useEdges, useHsv, converted, w, h)) {
+            converted.clear();
+        }
+        const std::vector<AsciiPixel>& ascii = temporalReuse ? temporal.convert(frame) : converted;
+        if (temporalReuse) {
+            w = temporal.width();
+            h = temporal.height();
+        }
+        convertMs += std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+            std::chrono::high_resolution_clock::now() - convertStart).count();
+        if (ascii.empty()) {
+            std::cerr << "[ERROR] Failed to convert frame " << i << std::endl;
+            return 1;
+        }
+
+        if (!opened) {
+            if (!writer.open(archivePath, w, h, useColors)) return 1;
+            opened = true;
+        }
+        if (!writer.append(ascii)) {
+            std::cerr << "[ERROR] Failed to write frame " << i << " to " << archivePath << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "[2/2] Writing index..." << std::endl;
+    int written = writer.frameCount();
+    if (!writer.close()) {
+        std::cerr << "[ERROR] Failed to finalize archive: " << archivePath << std::endl;
+        return 1;
+    }
+
+    double totalTimeMs = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+        std::chrono::high_resolution_clock::now() - totalStart).count();
+
+    std::cout << "[✓] Archive written to " << archivePath << std::endl;
+    std::cout << std::endl;
+    printf("METRIC:Archive_frames:%d\n", written);
+    printf("METRIC:Archive_bytes:%llu\n", static_cast<unsigned long long>(writer.bytesWritten()));
+    printf("METRIC:Archive_convert_ms:%.6f\n", convertMs);
+    if (temporalReuse) {
+        printf("METRIC:Temporal_dirty_ratio:%.6f\n", temporal.dirtyRatio());
+    }
+    printf("METRIC:TOTAL_ms:%.6f\n", totalTimeMs);
+    printMemStats();
+    return 0;
+}
+
+// Animated GIF (--archive or --play): frames are decoded in order on one
+// thread and converted concurrently on the frame pipeline, then appended to
+// the archive with their display times or played at their own timing.
+// fps > 0 replaces the GIF's timing, 0 plays unthrottled, < 0 keeps it.
+static int runGif(
+    const std::string& imagePath,
+    const std::string& archivePath,
+    int targetWidth,
+    int adjustedHeight,
+    bool useEdges,
+    bool useHsv,
+    bool useColors,
+    bool noRender,
+    double fps
+) {
+    using Clock = std::chrono::steady_clock;
+    auto totalStart = std::chrono::high_resolution_clock::now();
+
+    GifReader gif;
+    if (!gif.open(imagePath)) {
+        std::cerr << "[ERROR] Not a valid GIF: " << imagePath << std::endl;
+        return 1;
+    }
+
+    const int channels = pipelineChannels(useColors, useHsv);
+    FrameSource source = [&](Image& frame, int& delayMs) {
+        return gif.next(frame, delayMs, channels);
+    };
+    FrameConverter convert = [&](const Image& frame, PipelineFrame& out) {
+        if (!convertFrame(frame, targetWidth, adjustedHeight, useEdges, useHsv, out.ascii, out.width, out.height)) {
+            return false;
+        }
+        out.edgeSkipRatio = useEdges ? g_lastSobelSkipRatio : 0.0;
+        out.hsvMs = std::isnan(g_lastHsvMs) ? 0.0 : g_lastHsvMs;
+        return true;
+    };
+
+    const bool toArchive = !archivePath.empty();
+    const bool throttled = fps != 0.0;
+    AsciiArchiveWriter writer;
+    bool opened = false;
+    double convertMs = 0.0;
+    double convertMaxMs = 0.0;
+    double edgeSkipSum = 0.0;
+    double hsvMs = 0.0;
+    double renderMs = 0.0;
+    int lateFrames = 0;
+    Clock::time_point nextFrame;
+
+    FrameSink sink = [&](const PipelineFrame& frame) {
+        convertMs += frame.convertMs;
+        convertMaxMs = std::max(convertMaxMs, frame.convertMs);
+        edgeSkipSum += frame.edgeSkipRatio;
+        hsvMs += frame.hsvMs;
+        if (toArchive) {
+            if (!opened) {
+                if (!writer.open(archivePath, frame.width, frame.height, useColors)) return false;
+                opened = true;
+            }
+            if (!writer.append(frame.ascii, frame.delayMs)) {
+                std::cerr << "[ERROR] Failed to write frame " << frame.index << " to " << archivePath << std::endl;
+                return false;
+            }
+            return true;
+        }
+        if (noRender) return true;
+
+        // A frame converted after its slot is shown at once and the schedule restarts from it
+        Clock::time_point now = Clock::now();
+        if (frame.index == 0) {
+            std::cout << "\033[2J";
+            nextFrame = now;
+        } else if (now > nextFrame + std::chrono::milliseconds(1)) {
+            if (throttled) ++lateFrames;
+            nextFrame = now;
+        }
+        std::this_thread::sleep_until(nextFrame);
+
+        auto renderStart = Clock::now();
+        std::cout << "\033[H";
+        printAsciiArt(frame.ascii, frame.width, frame.height, useColors);
+        std::cout.flush();
+        renderMs += std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+            Clock::now() - renderStart).count();
+
+        double seconds = fps > 0.0 ? 1.0 / fps : (throttled ? frame.delayMs / 1000.0 : 0.0);
+        nextFrame += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        return true;
+    };
+
+    std::cout << "[1/2] Converting GIF frames on " << resolveThreadCount() << " worker(s)..." << std::endl;
+    PipelineStats stats;
+    bool ok = runFramePipeline(source, convert, sink, 0, 0, stats);
+    if (!ok || gif.failed()) {
+        std::cerr << "[ERROR] Failed to convert " << imagePath << " (frame " << stats.frames << ")" << std::endl;
+        return 1;
+    }
+
+    if (toArchive) {
+        std::cout << "[2/2] Writing index..." << std::endl;
+        if (!opened || !writer.close()) {
+            std::cerr << "[ERROR] Failed to finalize archive: " << archivePath << std::endl;
+            return 1;
+        }
+        std::cout << "[✓] Archive written to " << archivePath << std::endl;
+    }
+
+    double totalTimeMs = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+        std::chrono::high_resolution_clock::now() - totalStart).count();
+
+    std::cout << std::endl;
+    printf("METRIC:Gif_frames:%d\n", stats.frames);
+    printf("METRIC:Gif_convert_ms:%.6f\n", convertMs);
+    printf("METRIC:Gif_frame_convert_max_ms:%.6f\n", convertMaxMs);
+    printf("METRIC:Gif_peak_frames_in_flight:%d\n", stats.peakInFlight);
+    if (useEdges) {
+        printf("METRIC:Gif_edge_skip_ratio:%.6f\n", stats.frames > 0 ? edgeSkipSum / stats.frames : 0.0);
+    }
+    if (useHsv) {
+        printf("METRIC:Gif_hsv_ms:%.6f\n", hsvMs);
+    }
+    if (toArchive) {
+        printf("METRIC:Archive_frames:%d\n", writer.frameCount());
+        printf("METRIC:Archive_bytes:%llu\n", static_cast<unsigned long long>(writer.bytesWritten()));
+    } else if (!noRender) {
+        printf("METRIC:Gif_render_ms:%.6f\n", renderMs);
+        printf("METRIC:Gif_late_frames:%d\n", lateFrames);
+    }
+    printf("METRIC:TOTAL_ms:%.6f\n", totalTimeMs);
+    printMemStats();
+    return 0;
+}
+
+// Playback: mmap the archive and feed decoded frames to printAsciiArt
+static int runPlayback(
+    const std::string& archivePath,
+    int singleFrame,
+    double fps,
+    bool fpsSpecified,
+    bool useColors,
+    bool colorsFlagSpecified
+) {
+    AsciiArchiveReader reader;
+    if (!reader.open(archivePath)) {
+        std::cerr << "[ERROR] Not a valid .a2a archive: " << archivePath << std::endl;
+        return 1;
+    }
+
+    // Default to the archive's own color setting unless --colors/--no-colors was given
+    bool colors = reader.hasColors() && (useColors || !colorsFlagSpecified);
+    int first = singleFrame >= 0 ? singleFrame : 0;
+    int last = singleFrame >= 0 ? singleFrame : reader.frameCount() - 1;
+    if (first >= reader.frameCount()) {
+        std::cerr << "[ERROR] Frame " << singleFrame << " out of range (archive has "
+                  << reader.frameCount() << " frames)" << std::endl;
+        return 1;
+    }
+
+    auto frameInterval = std::chrono::duration<double>(fps > 0.0 ? 1.0 / fps : 0.0);
+    auto totalStart = std::chrono::high_resolution_clock::now();
+    auto nextFrame = totalStart;
+    double decodeMs = 0.0;
+    bool animate = last > first;
+
+    std::vector<AsciiPixel> grid;
+    if (animate) std::cout << "\033[2J";
+    for (int i = first; i <= last; ++i) {
+        auto decodeStart = std::chrono::high_resolution_clock::now();
+        if (!reader.frame(i, grid)) {
+            std::cerr << "[ERROR] Corrupt frame " << i << " in " << archivePath << std::endl;
+            return 1;
+        }
+        decodeMs += std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+            std::chrono::high_resolution_clock::now() - decodeStart).count();
+
+        if (animate) {
+            // Stored frame times (animated GIFs) win unless --fps was given
+            int delayMs = fpsSpecified ? 0 : reader.frameDelayMs(i);
+            std::this_thread::sleep_until(nextFrame);
+            nextFrame += std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+                delayMs > 0 ? std::chrono::duration<double>(delayMs / 1000.0) : frameInterval);
+            std::cout << "\033[H";
+        }
+        printAsciiArt(grid, reader.width(), reader.height(), colors);
+        std::cout.flush();
+    }
+
+    double totalTimeMs = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+        std::chrono::high_resolution_clock::now() - totalStart).count();
+
+    std::cout << std::endl;
+    printf("METRIC:Play_frames:%d\n", last - first + 1);
+    printf("METRIC:Play_decode_ms:%.6f\n", decodeMs);
+    printf("METRIC:TOTAL_ms:%.6f\n", totalTimeMs);
+    return 0;
+}
+
+// Compare two archives cell by cell; fails when either tolerance is exceeded
+static int runDiff(
+    const std::string& pathA,
+    const std::string& pathB,
+    double glyphTolerance,
+    int colorTolerance
+) {
+    AsciiArchiveReader a;
+    AsciiArchiveReader b;
+    if (!a.open(pathA) || !b.open(pathB)) {
+        std::cerr << "[ERROR] Cannot open archives " << pathA << " / " << pathB << std::endl;
+        return 1;
+    }
+    if (a.width() != b.width() || a.height() != b.height() || a.frameCount() != b.frameCount()) {
+        std::cerr << "[FAIL] Shape mismatch: " << a.width() << "x" << a.height() << "x" << a.frameCount()
+                  << " vs " << b.width() << "x" << b.height() << "x" << b.frameCount() << std::endl;
+        return 1;
+    }
+
+    bool compareColors = a.hasColors() && b.hasColors();
+    size_t glyphDiffs = 0;
+    size_t cells = 0;
+    int colorMax = 0;
+    std::vector<AsciiPixel> gridA;
+    std::vector<AsciiPixel> gridB;
+    for (int f = 0; f < a.frameCount(); ++f) {
+        if (!a.frame(f, gridA) || !b.frame(f, gridB)) {
+            std::cerr << "[ERROR] Corrupt frame " << f << std::endl;
+            return 1;
+        }
+        for (size_t i = 0; i < gridA.size(); ++i) {
+            if (gridA[i].character != gridB[i].character) ++glyphDiffs;
+            if (compareColors) {
+                colorMax = std::max({colorMax,
+                                     std::abs(gridA[i].r - gridB[i].r),
+                                     std::abs(gridA[i].g - gridB[i].g),
+                                     std::abs(gridA[i].b - gridB[i].b)});
+            }
+        }
+        cells += gridA.size();
+    }
+
+    double glyphRatio = cells > 0 ? static_cast<double>(glyphDiffs) / cells : 0.0;
+    bool pass = glyphRatio <= glyphTolerance && colorMax <= colorTolerance;
+    std::cout << (pass ? "[PASS] " : "[FAIL] ") << glyphDiffs << "/" << cells << " glyphs differ, max color delta "
+              << colorMax << std::endl;
+    printf("METRIC:Diff_glyph_ratio:%.6f\n", glyphRatio);
+    printf("METRIC:Diff_color_max:%d\n", colorMax);
+    return pass ? 0 : 1;
+}
+
 int main(int argc, char* argv[]) {
     std::cout << "==================================================" << std::endl;
     std::cout << "       Image to ASCII Art Converter v1.0" << std::endl;
@@ -79,12 +669,43 @@ int main(int argc, char* argv[]) {
     bool useColors = false;
     bool useHsv = false;
     bool noRender = false;
+    bool streamIngest = false;
+    bool thumbnailDecode = true;
+    size_t memoryCapBytes = 0;  // 0 = no cap
+    std::vector<std::pair<int, int>> multiSizes;
+    bool viewMode = false;
+    bool brailleMode = false;
     // Track which required flags were explicitly provided
     bool edgesFlagSpecified = false;
     bool hsvFlagSpecified = false;
     bool sobelAsmFlagSpecified = false;
     bool hsvAsmFlagSpecified = false;
     bool colorsFlagSpecified = false;
+    // Auto-tuning: only settings not given explicitly are taken from the profile
+    bool tuneMode = false;
+    bool autoMode = false;
+    std::string profilePath = kDefaultTuneProfile;
+    bool sobelAsmExplicit = false;
+    bool hsvAsmExplicit = false;
+    bool threadsExplicit = false;
+    // Directory watch
+    WatchOptions watchOptions;
+    // Grid dump / comparison
+    std::string dumpPath;
+    std::string diffPath;
+    double diffTolerance = 0.0;
+    int diffColorTolerance = 0;
+    // HTML/SVG export
+    ExportOptions exportOptions;
+    exportOptions.format = ExportFormat::Ansi;
+    std::string outputPath;
+    // Archive write / playback
+    std::string archivePath;
+    bool playMode = false;
+    bool temporalReuse = true;
+    int playFrame = -1;
+    double playFps = 12.0;
+    bool fpsSpecified = false;
 
     // Parse optional arguments
     for (int i = 2; i < argc; ++i) {
@@ -96,9 +717,66 @@ int main(int argc, char* argv[]) {
         } else if (arg == "--no-edges") {
             useEdges = false;
             edgesFlagSpecified = true;
-        } else if (arg == "--edges") {
+        } else if (arg == "--edges" || arg == "--edges=sobel") {
             useEdges = true;
             edgesFlagSpecified = true;
+            g_edgeMode = EdgeMode::Sobel;
+        } else if (arg == "--edges=canny") {
+            useEdges = true;
+            edgesFlagSpecified = true;
+            g_edgeMode = EdgeMode::Canny;
+        } else if ((arg == "--canny-low" || arg == "--canny-high") && i + 1 < argc) {
+            float& threshold = arg == "--canny-low" ? g_cannyLow : g_cannyHigh;
+            try {
+                threshold = std::max(0.001f, std::min(1.0f, std::stof(argv[++i])));
+            } catch (...) {
+                std::cerr << "[ERROR] Invalid " << arg << " value" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--levels" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "off") {
+                g_levelsMode = LevelsMode::Off;
+            } else if (mode == "auto") {
+                g_levelsMode = LevelsMode::Auto;
+            } else if (mode == "equalize") {
+                g_levelsMode = LevelsMode::Equalize;
+            } else {
+                std::cerr << "[ERROR] Unknown levels mode: " << mode << " (expected off, auto or equalize)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--dither" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "none") {
+                g_ditherMode = DitherMode::None;
+            } else if (mode == "fs") {
+                g_ditherMode = DitherMode::FloydSteinberg;
+            } else if (mode == "atkinson") {
+                g_ditherMode = DitherMode::Atkinson;
+            } else {
+                std::cerr << "[ERROR] Unknown dither mode: " << mode << " (expected none, fs or atkinson)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--mode" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "ascii") {
+                brailleMode = false;
+            } else if (mode == "braille") {
+                brailleMode = true;
+            } else {
+                std::cerr << "[ERROR] Unknown output mode: " << mode << " (expected ascii or braille)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--glyphs" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "density") {
+                g_glyphMode = GlyphMode::Density;
+            } else if (mode == "structure") {
+                g_glyphMode = GlyphMode::Structure;
+            } else {
+                std::cerr << "[ERROR] Unknown glyph mode: " << mode << " (expected density or structure)" << std::endl;
+                return 1;
+            }
         } else if (arg == "--colors") {
             useColors = true;
             colorsFlagSpecified = true;
@@ -109,14 +787,20 @@ int main(int argc, char* argv[]) {
             // legacy: enable all ASM backends
             g_sobelAsm = true;
             g_hsvAsm = true;
+            g_brailleAsm = true;
             sobelAsmFlagSpecified = true;
             hsvAsmFlagSpecified = true;
+            sobelAsmExplicit = true;
+            hsvAsmExplicit = true;
         } else if (arg == "--asm-off" || arg == "--no-asm") {
             // legacy: disable all ASM backends
             g_sobelAsm = false;
             g_hsvAsm = false;
+            g_brailleAsm = false;
             sobelAsmFlagSpecified = true;
             hsvAsmFlagSpecified = true;
+            sobelAsmExplicit = true;
+            hsvAsmExplicit = true;
         } else if (arg == "--use-hsv" || arg == "--hsv") {
             // Enable HSV conversion; by default also enable hsv ASM
             useHsv = true;
@@ -129,18 +813,52 @@ int main(int argc, char* argv[]) {
             g_hsvAsm = false;
             hsvFlagSpecified = true;
             hsvAsmFlagSpecified = true;
+        } else if (arg == "--hsv-lut") {
+            g_hsvLut = true;
+        } else if (arg == "--no-hsv-lut") {
+            g_hsvLut = false;
+        } else if (arg == "--hue-range" && i + 1 < argc) {
+            float hueMin = 0.0f;
+            float hueMax = 0.0f;
+            char tail = 0;
+            if (std::sscanf(argv[++i], "%f-%f%c", &hueMin, &hueMax, &tail) != 2
+                || hueMin < 0.0f || hueMax < 0.0f || hueMin > 360.0f || hueMax > 360.0f) {
+                std::cerr << "[ERROR] Invalid --hue-range value (expected <min>-<max> in degrees)" << std::endl;
+                return 1;
+            }
+            g_hueRule.hueMin = hueMin;
+            g_hueRule.hueMax = hueMax;
+        } else if (arg == "--hue-saturation" && i + 1 < argc) {
+            try {
+                g_hueRule.saturationMin = std::max(0.0f, std::min(1.0f, std::stof(argv[++i])));
+            } catch (...) {
+                std::cerr << "[ERROR] Invalid --hue-saturation value" << std::endl;
+                return 1;
+            }
         } else if (arg == "--sobel-asm") {
             g_sobelAsm = true;
             sobelAsmFlagSpecified = true;
+            sobelAsmExplicit = true;
         } else if (arg == "--no-sobel-asm") {
             g_sobelAsm = false;
             sobelAsmFlagSpecified = true;
+            sobelAsmExplicit = true;
+        } else if (arg == "--braille-asm") {
+            g_brailleAsm = true;
+        } else if (arg == "--no-braille-asm") {
+            g_brailleAsm = false;
+        } else if (arg == "--no-flat-skip") {
+            g_sobelFlatSkip = false;
+        } else if (arg == "--rgb") {
+            g_grayFastPath = false;
         } else if (arg == "--hsv-asm") {
             g_hsvAsm = true;
             hsvAsmFlagSpecified = true;
+            hsvAsmExplicit = true;
         } else if (arg == "--no-hsv-asm") {
             g_hsvAsm = false;
             hsvAsmFlagSpecified = true;
+            hsvAsmExplicit = true;
         } else if ((arg == "--threads" || arg == "--workers") && i + 1 < argc) {
             try {
                 g_threadCount = std::stoi(argv[++i]);
@@ -148,9 +866,100 @@ int main(int argc, char* argv[]) {
             } catch (...) {
                 g_threadCount = 0;
             }
+            threadsExplicit = true;
         }
         else if (arg == "--no-render") {
             noRender = true;
+        } else if (arg == "--sizes" && i + 1 < argc) {
+            if (!parseSizeList(argv[++i], multiSizes)) {
+                std::cerr << "[ERROR] Invalid --sizes list (expected e.g. 80x30,120x60)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--tune") {
+            tuneMode = true;
+        } else if (arg == "--auto") {
+            autoMode = true;
+        } else if (arg == "--profile" && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else if (arg == "--watch" && i + 1 < argc) {
+            watchOptions.directory = argv[++i];
+        } else if (arg == "--out-dir" && i + 1 < argc) {
+            watchOptions.outputDirectory = argv[++i];
+        } else if (arg == "--watch-workers" && i + 1 < argc) {
+            try {
+                watchOptions.workers = std::max(0, std::stoi(argv[++i]));
+            } catch (...) {
+                watchOptions.workers = 0;
+            }
+        } else if (arg == "--watch-limit" && i + 1 < argc) {
+            try {
+                watchOptions.fileLimit = std::max(0, std::stoi(argv[++i]));
+            } catch (...) {
+                watchOptions.fileLimit = 0;
+            }
+        } else if (arg == "--dump" && i + 1 < argc) {
+            dumpPath = argv[++i];
+        } else if (arg == "--diff" && i + 1 < argc) {
+            diffPath = argv[++i];
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            try {
+                diffTolerance = std::stod(argv[++i]);
+            } catch (...) {
+                diffTolerance = 0.0;
+            }
+        } else if (arg == "--color-tolerance" && i + 1 < argc) {
+            try {
+                diffColorTolerance = std::stoi(argv[++i]);
+            } catch (...) {
+                diffColorTolerance = 0;
+            }
+        } else if (arg == "--format" && i + 1 < argc) {
+            if (!parseExportFormat(argv[++i], exportOptions.format)) {
+                std::cerr << "[ERROR] Unknown --format (expected ansi, html or svg)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (arg == "--quantize" && i + 1 < argc) {
+            try {
+                exportOptions.quantizeBits = std::max(0, std::min(7, std::stoi(argv[++i])));
+            } catch (...) {
+                exportOptions.quantizeBits = 0;
+            }
+        } else if (arg == "--archive" && i + 1 < argc) {
+            archivePath = argv[++i];
+        } else if (arg == "--no-temporal") {
+            temporalReuse = false;
+        } else if (arg == "--play") {
+            playMode = true;
+        } else if (arg == "--frame" && i + 1 < argc) {
+            try {
+                playFrame = std::stoi(argv[++i]);
+            } catch (...) {
+                playFrame = -1;
+            }
+        } else if (arg == "--fps" && i + 1 < argc) {
+            try {
+                playFps = std::stod(argv[++i]);
+                fpsSpecified = true;
+            } catch (...) {
+                playFps = 12.0;
+            }
+        } else if (arg == "--view") {
+            viewMode = true;
+        } else if (arg == "--stream") {
+            streamIngest = true;
+        } else if (arg == "--full-decode") {
+            thumbnailDecode = false;
+        } else if (arg == "--mem-stats") {
+            g_memStats = true;
+        } else if (arg == "--max-memory" && i + 1 < argc) {
+            try {
+                long long mb = std::stoll(argv[++i]);
+                memoryCapBytes = mb > 0 ? static_cast<size_t>(mb) * 1024 * 1024 : 0;
+            } catch (...) {
+                memoryCapBytes = 0;
+            }
         }
     }
 
@@ -160,6 +969,45 @@ int main(int argc, char* argv[]) {
     std::cout << "[" << (anyAsm ? "Assembly" : "C++") << "] Test: 10 + 5 = " << armTestResult << std::endl;
     std::cout << std::endl;
 
+    if (tuneMode) {
+        Image sample = ImageLoader::loadImage(imagePath, 3);
+        if (!sample.isValid()) {
+            std::cerr << "[ERROR] Failed to load image!" << std::endl;
+            return 1;
+        }
+
+        std::cout << "[Tune] Benchmarking stage backends..." << std::endl;
+        TuneProfile profile = runTuning(sample);
+        if (!profile.save(profilePath)) {
+            std::cerr << "[ERROR] Cannot write tuning profile: " << profilePath << std::endl;
+            return 1;
+        }
+        std::cout << "[✓] Tuning profile written to " << profilePath << std::endl;
+
+        for (const TuneEntry& e : profile.entries) {
+            printf("METRIC:Tune_%s_%d_%s_t%d_ms:%.6f\n", e.stage.c_str(), e.pixels,
+                   e.useAsm ? "asm" : "cpp", e.threads, e.ms);
+        }
+        return 0;
+    }
+
+    if (!diffPath.empty()) {
+        return runDiff(imagePath, diffPath, diffTolerance, diffColorTolerance);
+    }
+
+    // Playback only decodes stored glyphs; no conversion options apply
+    // (an animated GIF is converted first and needs them)
+    const bool gifInput = GifReader::isGif(imagePath);
+    if (playMode && !gifInput) {
+        return runPlayback(imagePath, playFrame, playFps, fpsSpecified, useColors, colorsFlagSpecified);
+    }
+
+    // In auto mode the backend choices come from the profile
+    if (autoMode) {
+        sobelAsmFlagSpecified = true;
+        hsvAsmFlagSpecified = true;
+    }
+
     // Enforce that required option groups were explicitly specified (colors may be omitted)
     // Required groups: edges, hsv choice, sobel-asm choice, hsv-asm choice
     std::vector<std::string> missing;
@@ -177,65 +1025,216 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    // Braille cells are not AsciiPixels: only the single-image ANSI path draws them
+    if (brailleMode && (!watchOptions.directory.empty() || !multiSizes.empty() || !archivePath.empty()
+                        || playMode || viewMode || !dumpPath.empty() || exportOptions.format != ExportFormat::Ansi)) {
+        std::cerr << "[ERROR] --mode braille only supports single-image ANSI output "
+                  << "(not --watch, --sizes, --archive, --play, --view, --dump or --format html/svg)" << std::endl;
+        return 1;
+    }
+
+    // The levels table remaps luma; HSV mode takes brightness from V and would ignore it
+    if (useHsv && g_levelsMode != LevelsMode::Off) {
+        std::cerr << "[ERROR] --levels applies to luma and cannot be combined with --hsv" << std::endl;
+        return 1;
+    }
+
+    // Progress and METRIC lines go to stdout, so a document there would be corrupted
+    if (exportOptions.format != ExportFormat::Ansi && outputPath.empty() && watchOptions.directory.empty()) {
+        std::cerr << "[ERROR] --format html/svg requires --output <file>" << std::endl;
+        return 1;
+    }
+
     std::cout << "[Config] Target dimensions: " << targetWidth << "x" << targetHeight << std::endl;
-    std::cout << "[Config] Edge detection: " << (useEdges ? "enabled" : "disabled") << std::endl;
+    std::cout << "[Config] Edge detection: "
+              << (useEdges ? (g_edgeMode == EdgeMode::Canny ? "canny" : "enabled") : "disabled") << std::endl;
     std::cout << "[Config] Colors: " << (useColors ? "enabled" : "disabled") << std::endl;
+    if (brailleMode) {
+        std::cout << "[Config] Mode: braille (" << (g_brailleAsm ? "asm" : "cpp") << " dot packing)" << std::endl;
+    } else {
+        std::cout << "[Config] Glyphs: " << (g_glyphMode == GlyphMode::Structure ? "structure" : "density") << std::endl;
+    }
+    std::cout << "[Config] Decode: " << (pipelineChannels(useColors, useHsv) == 1 ? "grayscale" : "rgb") << std::endl;
     std::cout << "[Config] Sobel ASM: " << (g_sobelAsm ? "enabled" : "disabled") << std::endl;
     std::cout << "[Config] HSV ASM: " << (g_hsvAsm ? "enabled" : "disabled") << std::endl;
+    if (useHsv) {
+        std::cout << "[Config] HSV: " << (g_hsvLut ? "rgb565 table" : "per pixel") << ", hues " << g_hueRule.hueMin
+                  << "-" << g_hueRule.hueMax << " above saturation " << g_hueRule.saturationMin << std::endl;
+    }
     std::cout << std::endl;
 
-    // Start total timer
-    auto totalStart = std::chrono::high_resolution_clock::now();
-
-    // ========================================================================
-    // STEP 1: Load Image
-    // ========================================================================
-    std::cout << "[1/5] Loading image..." << std::endl;
-    auto loadStart = std::chrono::high_resolution_clock::now();
+    if (!watchOptions.directory.empty()) {
+        watchOptions.targetWidth = targetWidth;
+        watchOptions.adjustedHeight = static_cast<int>(targetHeight * 0.75f);
+        watchOptions.useEdges = useEdges;
+        watchOptions.useHsv = useHsv;
+        watchOptions.useColors = useColors;
+        watchOptions.thumbnails = thumbnailDecode;
+        watchOptions.exportOptions = exportOptions;
+        return runWatch(watchOptions);
+    }
 
-    Image originalImg = ImageLoader::loadImage(imagePath, 3);  // Load as RGB
+    if (!multiSizes.empty()) {
+        return runMultiSize(imagePath, multiSizes, useEdges, useHsv, useColors, noRender);
+    }
 
-    auto loadEnd = std::chrono::high_resolution_clock::now();
-    auto loadTime = std::chrono::duration_cast<std::chrono::milliseconds>(loadEnd - loadStart).count();
+    if (gifInput && (playMode || !archivePath.empty())) {
+        int adjustedHeight = static_cast<int>(targetHeight * 0.75f);
+        return runGif(imagePath, archivePath, targetWidth, adjustedHeight, useEdges, useHsv, useColors, noRender,
+                      fpsSpecified ? playFps : -1.0);
+    }
 
-    if (!originalImg.isValid()) {
-        std::cerr << "[ERROR] Failed to load image!" << std::endl;
-        return 1;
+    if (!archivePath.empty()) {
+        int adjustedHeight = static_cast<int>(targetHeight * 0.75f);
+        return runArchive(imagePath, archivePath, targetWidth, adjustedHeight, useEdges, useHsv, useColors,
+                          temporalReuse);
     }
 
-    std::cout << "[✓] Image loaded" << std::endl;
-    std::cout << "    Dimensions: " << originalImg.width << "x" << originalImg.height << std::endl;
-    std::cout << "    Channels: " << originalImg.channels << std::endl;
-    std::cout << std::endl;
+    if (viewMode) {
+        Image viewImg = ImageLoader::loadImage(imagePath, pipelineChannels(useColors, useHsv));
+        if (!viewImg.isValid()) {
+            std::cerr << "[ERROR] Failed to load image!" << std::endl;
+            return 1;
+        }
+        ViewerOptions viewerOptions;
+        viewerOptions.useEdges = useEdges;
+        viewerOptions.useHsv = useHsv;
+        viewerOptions.useColors = useColors;
+        return runViewer(std::move(viewImg), viewerOptions);
+    }
 
-    // ========================================================================
-    // STEP 2: Scale Image
-    // ========================================================================
-    std::cout << "[2/5] Scaling image..." << std::endl;
-    auto scaleStart = std::chrono::high_resolution_clock::now();
+    // Start total timer
+    auto totalStart = std::chrono::high_resolution_clock::now();
 
     // Terminal characters are typically ~2x taller than wide
     // Adjust target height to compensate for aspect ratio
     // Using 0.75 to get better vertical coverage (not too squashed)
     int adjustedHeight = static_cast<int>(targetHeight * 0.75f);
-    Image scaledImg = scaleImage(originalImg, targetWidth, adjustedHeight, 1.0f);
 
-    auto scaleEnd = std::chrono::high_resolution_clock::now();
-    auto scaleTime = std::chrono::duration_cast<std::chrono::milliseconds>(scaleEnd - scaleStart).count();
-    auto scaleTimeMicro = std::chrono::duration_cast<std::chrono::microseconds>(scaleEnd - scaleStart).count();
+    // Braille draws 2x4 scaled pixels per cell, ASCII one
+    const int scaledWidth = targetWidth * (brailleMode ? 2 : 1);
+    const int scaledHeight = adjustedHeight * (brailleMode ? 4 : 1);
 
-    if (!scaledImg.isValid()) {
-        std::cerr << "[ERROR] Failed to scale image!" << std::endl;
-        return 1;
+    // Without colors or HSV only luma is needed: decode one channel (a colour
+    // source is still decoded to RGB first, see ImageLoader::loadImage)
+    const int channels = pipelineChannels(useColors, useHsv);
+
+    // The thumbnail probe and streaming ingest are accounted to loading too
+    memStatsStage(MemStage::Load);
+
+    // Small targets can often be served from the JPEG's embedded thumbnail
+    // (shape matching needs kGlyphCols x kGlyphRows pixels per cell)
+    const bool structureGlyphs = g_glyphMode == GlyphMode::Structure && !brailleMode;
+    Image thumbnailImg;
+    if (thumbnailDecode && !streamIngest) {
+        thumbnailImg = ImageLoader::loadThumbnail(imagePath,
+                                                  structureGlyphs ? targetWidth * kGlyphCols : scaledWidth,
+                                                  structureGlyphs ? adjustedHeight * kGlyphRows : scaledHeight,
+                                                  channels);
+    }
+    const bool thumbnailHit = thumbnailImg.isValid();
+
+    // Fall back to streaming ingest when a full decode would not fit the cap
+    if (!streamIngest && !thumbnailHit && memoryCapBytes > 0
+        && StreamingLoader::estimateDecodeBytes(imagePath, channels) > memoryCapBytes) {
+        std::cout << "[Config] Full decode exceeds --max-memory, using streaming ingest" << std::endl;
+        streamIngest = true;
+    }
+
+    Image scaledImg;
+    Image structureSource;  // full-resolution image kept for --glyphs structure
+    size_t ingestPeakBytes = 0;
+
+    if (streamIngest) {
+        // ====================================================================
+        // STEP 1+2: Streaming load with incremental scaling
+        // ====================================================================
+        std::cout << "[1/5] Loading image (streaming)..." << std::endl;
+        std::cout << "[2/5] Scaling rows as they are decoded..." << std::endl;
+
+        scaledImg = StreamingLoader::loadScaled(imagePath, scaledWidth, scaledHeight, channels,
+                                                memoryCapBytes, &ingestPeakBytes);
+
+        if (!scaledImg.isValid()) {
+            std::cerr << "[ERROR] Failed to load image!" << std::endl;
+            return 1;
+        }
+        if (structureGlyphs) {
+            std::cout << "[Config] Streaming ingest keeps no full image; using density glyphs" << std::endl;
+        }
+    } else {
+        // ====================================================================
+        // STEP 1: Load Image
+        // ====================================================================
+        std::cout << (thumbnailHit ? "[1/5] Loading embedded thumbnail..." : "[1/5] Loading image...") << std::endl;
+
+        Image originalImg = thumbnailHit
+            ? std::move(thumbnailImg)
+            : ImageLoader::loadImage(imagePath, channels);  // RGB, or luma only
+
+        if (!originalImg.isValid()) {
+            std::cerr << "[ERROR] Failed to load image!" << std::endl;
+            return 1;
+        }
+
+        ingestPeakBytes = imageByteSize(originalImg);
+
+        std::cout << "[✓] Image loaded" << std::endl;
+        std::cout << "    Dimensions: " << originalImg.width << "x" << originalImg.height << std::endl;
+        std::cout << "    Channels: " << originalImg.channels << std::endl;
+        std::cout << std::endl;
+
+        // ====================================================================
+        // STEP 2: Scale Image
+        // ====================================================================
+        std::cout << "[2/5] Scaling image..." << std::endl;
+        memStatsStage(MemStage::Scale);
+
+        scaledImg = scaleImage(originalImg, scaledWidth, scaledHeight, 1.0f);
+
+        if (!scaledImg.isValid()) {
+            std::cerr << "[ERROR] Failed to scale image!" << std::endl;
+            return 1;
+        }
+        if (structureGlyphs) {
+            structureSource = std::move(originalImg);
+        }
     }
 
     std::cout << "[✓] Image scaled" << std::endl;
     std::cout << "    New dimensions: " << scaledImg.width << "x" << scaledImg.height << std::endl;
     std::cout << std::endl;
 
+    // Auto-tuning: choose per-stage backend and threads for the actual frame size
+    bool tuneProfileLoaded = false;
+    if (autoMode) {
+        TuneProfile profile;
+        tuneProfileLoaded = profile.load(profilePath);
+        int pixels = scaledImg.width * scaledImg.height;
+        TuneChoice sobel;
+        TuneChoice hsv;
+
+        if (!tuneProfileLoaded) {
+            std::cout << "[Auto] No tuning profile at " << profilePath << " (run --tune); using defaults" << std::endl;
+        } else {
+            if (profile.pick("sobel", pixels, sobel)) {
+                if (!sobelAsmExplicit) g_sobelAsm = sobel.useAsm;
+                if (!threadsExplicit) g_sobelThreadCount = sobel.threads;
+            }
+            if (profile.pick("hsv", pixels, hsv) && !hsvAsmExplicit) {
+                g_hsvAsm = hsv.useAsm;
+            }
+        }
+
+        std::cout << "[Auto] Sobel: " << (g_sobelAsm ? "asm" : "cpp") << ", threads " << resolveSobelThreadCount()
+                  << "; HSV: " << (g_hsvAsm ? "asm" : "cpp") << std::endl;
+        std::cout << std::endl;
+    }
+
     // ========================================================================
     // STEP 3: Detect Edges (Optional)
     // ========================================================================
+    memStatsStage(MemStage::Edges);
     EdgeMap* edges = nullptr;
     auto edgeTime = 0LL;
     auto edgeTimeMicro = 0LL;
@@ -243,7 +1242,7 @@ int main(int argc, char* argv[]) {
         std::cout << "[3/5] Detecting edges (Sobel operator)..." << std::endl;
         auto edgeStart = std::chrono::high_resolution_clock::now();
 
-        EdgeMap edgeResult = detectEdgesSobel(scaledImg);
+        EdgeMap edgeResult = detectEdges(scaledImg);
         edges = new EdgeMap(std::move(edgeResult));
 
         auto edgeEnd = std::chrono::high_resolution_clock::now();
@@ -267,26 +1266,81 @@ int main(int argc, char* argv[]) {
     // ========================================================================
     // STEP 4: Convert to ASCII
     // ========================================================================
-    std::cout << "[4/5] Converting to ASCII art..." << std::endl;
+    std::cout << (brailleMode ? "[4/5] Packing braille dots..." : "[4/5] Converting to ASCII art...") << std::endl;
+    memStatsStage(MemStage::Ascii);
     auto asciiStart = std::chrono::high_resolution_clock::now();
 
-    std::vector<AsciiPixel> asciiArt = convertToAscii(scaledImg, edges, useEdges, useHsv);
+    std::vector<AsciiPixel> asciiArt;
+    std::vector<BrailleCell> brailleArt;
+    if (brailleMode) {
+        brailleArt = convertToBraille(scaledImg, edges);
+    } else {
+        asciiArt = convertToAscii(scaledImg, edges, useEdges, useHsv);
+    }
+
+    double structureMs = -1.0;
+    if (structureSource.isValid()) {
+        auto structureStart = std::chrono::high_resolution_clock::now();
+        matchGlyphStructure(structureSource, scaledImg.width, scaledImg.height, asciiArt.data());
+        structureMs = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+            std::chrono::high_resolution_clock::now() - structureStart).count();
+    }
 
     auto asciiEnd = std::chrono::high_resolution_clock::now();
     auto asciiTime = std::chrono::duration_cast<std::chrono::milliseconds>(asciiEnd - asciiStart).count();
     auto asciiTimeMicro = std::chrono::duration_cast<std::chrono::microseconds>(asciiEnd - asciiStart).count();
 
     std::cout << "[✓] ASCII conversion completed" << std::endl;
-    std::cout << "    Generated " << asciiArt.size() << " characters" << std::endl;
+    std::cout << "    Generated " << (brailleMode ? brailleArt.size() : asciiArt.size()) << " characters" << std::endl;
     std::cout << std::endl;
 
+    if (!dumpPath.empty()) {
+        AsciiArchiveWriter dump;
+        if (!dump.open(dumpPath, scaledImg.width, scaledImg.height, true)
+            || !dump.append(asciiArt) || !dump.close()) {
+            std::cerr << "[ERROR] Failed to write grid dump: " << dumpPath << std::endl;
+            delete edges;
+            return 1;
+        }
+    }
+
     // ========================================================================
     // STEP 5: Display Result
     // ========================================================================
+    memStatsStage(MemStage::Render);
+    size_t exportBytes = 0;
+    double exportMs = -1.0;
+    double brailleWriteMs = -1.0;
     if (noRender) {
         std::cout << "[5/5] Skipping rendering (no-render)" << std::endl;
         std::cout << "[✓] Conversion completed successfully!" << std::endl;
         std::cout << std::endl;
+    } else if (exportOptions.format != ExportFormat::Ansi) {
+        std::cout << "[5/5] Exporting " << (exportOptions.format == ExportFormat::Html ? "HTML" : "SVG") << "..." << std::endl;
+        std::cout.flush();
+
+        FILE* out = std::fopen(outputPath.c_str(), "wb");
+        if (out == nullptr) {
+            std::cerr << "[ERROR] Cannot open output file: " << outputPath << std::endl;
+            delete edges;
+            return 1;
+        }
+
+        auto exportStart = std::chrono::high_resolution_clock::now();
+        exportOptions.useColors = useColors;
+        exportBytes = exportAscii(asciiArt, scaledImg.width, scaledImg.height, exportOptions, out);
+        exportMs = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+            std::chrono::high_resolution_clock::now() - exportStart).count();
+        if (std::fclose(out) != 0) exportBytes = 0;
+
+        if (exportBytes == 0) {
+            std::cerr << "[ERROR] Export failed" << std::endl;
+            delete edges;
+            return 1;
+        }
+        std::cout << "[✓] Wrote " << exportBytes << " bytes to " << outputPath << std::endl;
+        std::cout << "[✓] Conversion completed successfully!" << std::endl;
+        std::cout << std::endl;
     } else {
         std::cout << "[5/5] Rendering ASCII art..." << std::endl;
         auto renderStart = std::chrono::high_resolution_clock::now();
@@ -294,14 +1348,17 @@ int main(int argc, char* argv[]) {
         std::cout << "==================================================" << std::endl;
         std::cout << std::endl;
 
-        printAsciiArt(asciiArt, scaledImg.width, scaledImg.height, useColors);
+        if (brailleMode) {
+            writeBrailleArt(std::cout, brailleArt, scaledImg.width / 2, scaledImg.height / 4, useColors);
+        } else {
+            printAsciiArt(asciiArt, scaledImg.width, scaledImg.height, useColors);
+        }
+        auto renderEnd = std::chrono::high_resolution_clock::now();
+        brailleWriteMs = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(renderEnd - renderStart).count();
 
         std::cout << std::endl;
         std::cout << "==================================================" << std::endl;
 
-        auto renderEnd = std::chrono::high_resolution_clock::now();
-        (void)renderEnd; // renderEnd used below when computing total
-
         std::cout << "[✓] Conversion completed successfully!" << std::endl;
         std::cout << std::endl;
     }
@@ -327,17 +1384,38 @@ int main(int argc, char* argv[]) {
     // Machine-readable metrics for benchmark scripts
     if (useEdges) {
         printf("METRIC:EdgeDetection_ms:%.6f\n", edgeMs);
+        printf("METRIC:EdgeSkip_ratio:%.6f\n", g_lastSobelSkipRatio);
     } else {
         printf("METRIC:EdgeDetection_ms:nan\n");
     }
     printf("METRIC:TOTAL_ms:%.6f\n", totalTimeMs);
+    printf("METRIC:IngestPeak_bytes:%zu\n", ingestPeakBytes);
+    printf("METRIC:Thumbnail_hit:%d\n", thumbnailHit ? 1 : 0);
+    if (brailleMode) {
+        printf("METRIC:Braille_ms:%.6f\n", static_cast<double>(asciiTimeMicro) / 1000.0);
+        if (brailleWriteMs >= 0.0) printf("METRIC:Braille_write_ms:%.6f\n", brailleWriteMs);
+    }
+    if (structureMs >= 0.0) {
+        printf("METRIC:Structure_ms:%.6f\n", structureMs);
+        printf("METRIC:Structure_cells_ratio:%.6f\n", g_lastStructureRatio);
+    }
+    if (exportMs >= 0.0) {
+        printf("METRIC:Export_bytes:%zu\n", exportBytes);
+        printf("METRIC:Export_ms:%.6f\n", exportMs);
+    }
+    if (autoMode) {
+        printf("METRIC:Tune_profile_loaded:%d\n", tuneProfileLoaded ? 1 : 0);
+        printf("METRIC:Tune_sobel_asm:%d\n", g_sobelAsm ? 1 : 0);
+        printf("METRIC:Tune_sobel_threads:%d\n", resolveSobelThreadCount());
+        printf("METRIC:Tune_hsv_asm:%d\n", g_hsvAsm ? 1 : 0);
+    }
     // HSV metric (may be NaN if not used)
-    extern double g_lastHsvMs;
     if (!std::isnan(g_lastHsvMs)) {
         printf("METRIC:HSV_ms:%.6f\n", g_lastHsvMs);
     } else {
         printf("METRIC:HSV_ms:nan\n");
     }
+    printMemStats();
 
     // ========================================================================
     // Cleanup
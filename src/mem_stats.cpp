@@ -0,0 +1,215 @@
+#include "../include/mem_stats.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+namespace {
+
+constexpr int kStageCount = static_cast<int>(MemStage::Count);
+constexpr const char* kStageNames[kStageCount] = {"Other", "Load", "Scale", "Edges", "Ascii", "Render"};
+
+// Constant-initialized: operator new may run before any dynamic initializer
+struct StageCounters {
+    std::atomic<uint64_t> allocs{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<int64_t> peakLive{0};  // most live heap bytes while the stage ran
+    long rssKb = -1;                   // sampled when the stage ended
+    long hwmKb = -1;
+    bool ran = false;
+};
+
+StageCounters stages[kStageCount];
+std::atomic<int> currentStage{0};
+// Heap bytes allocated while counting and not yet freed. Blocks allocated
+// before counting started and freed later make it undercount slightly.
+std::atomic<int64_t> liveBytes{0};
+
+size_t blockSize(void* buffer) {
+#if defined(__APPLE__)
+    return malloc_size(buffer);
+#else
+    return malloc_usable_size(buffer);
+#endif
+}
+
+void raisePeak(std::atomic<int64_t>& peak, int64_t value) {
+    int64_t seen = peak.load(std::memory_order_relaxed);
+    while (value > seen && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+void noteAlloc(void* buffer) {
+    if (buffer == nullptr) return;
+    int64_t size = static_cast<int64_t>(blockSize(buffer));
+    StageCounters& stage = stages[currentStage.load(std::memory_order_relaxed)];
+    stage.allocs.fetch_add(1, std::memory_order_relaxed);
+    stage.bytes.fetch_add(static_cast<uint64_t>(size), std::memory_order_relaxed);
+    raisePeak(stage.peakLive, liveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+}
+
+void noteFree(void* buffer) {
+    if (buffer == nullptr) return;
+    liveBytes.fetch_sub(static_cast<int64_t>(blockSize(buffer)), std::memory_order_relaxed);
+}
+
+// VmRSS and VmHWM in kB (-1 when /proc is unavailable; the high-water mark
+// then falls back to getrusage)
+void sampleRss(long& rssKb, long& hwmKb) {
+    rssKb = -1;
+    hwmKb = -1;
+    if (FILE* status = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        while (std::fgets(line, sizeof(line), status) != nullptr) {
+            std::sscanf(line, "VmRSS: %ld kB", &rssKb);
+            std::sscanf(line, "VmHWM: %ld kB", &hwmKb);
+        }
+        std::fclose(status);
+    }
+    if (hwmKb < 0) {
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+            hwmKb = usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+            hwmKb = usage.ru_maxrss;
+#endif
+        }
+    }
+}
+
+void* countedNew(size_t size) {
+    void* buffer = std::malloc(size != 0 ? size : 1);
+    if (buffer == nullptr) throw std::bad_alloc();
+    if (g_memStats) noteAlloc(buffer);
+    return buffer;
+}
+
+void* countedAlignedNew(size_t size, std::align_val_t alignment) {
+    size_t align = static_cast<size_t>(alignment);
+    void* buffer = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align);
+    if (buffer == nullptr) throw std::bad_alloc();
+    if (g_memStats) noteAlloc(buffer);
+    return buffer;
+}
+
+void countedDelete(void* buffer) noexcept {
+    if (g_memStats) noteFree(buffer);
+    std::free(buffer);
+}
+
+} // namespace
+
+void* trackedMalloc(size_t bytes) {
+    void* buffer = std::malloc(bytes);
+    if (g_memStats) noteAlloc(buffer);
+    return buffer;
+}
+
+void* trackedAlignedAlloc(size_t alignment, size_t bytes) {
+    void* buffer = std::aligned_alloc(alignment, bytes);
+    if (g_memStats) noteAlloc(buffer);
+    return buffer;
+}
+
+void* trackedRealloc(void* buffer, size_t bytes) {
+    if (!g_memStats) return std::realloc(buffer, bytes);
+    size_t oldSize = buffer != nullptr ? blockSize(buffer) : 0;
+    void* moved = std::realloc(buffer, bytes);
+    if (moved == nullptr) return nullptr;  // the old block is untouched
+    liveBytes.fetch_sub(static_cast<int64_t>(oldSize), std::memory_order_relaxed);
+    noteAlloc(moved);
+    return moved;
+}
+
+void trackedFree(void* buffer) {
+    if (g_memStats) noteFree(buffer);
+    std::free(buffer);
+}
+
+void memStatsStage(MemStage stage) {
+    if (!g_memStats) return;
+    StageCounters& done = stages[currentStage.load(std::memory_order_relaxed)];
+    done.ran = true;
+    sampleRss(done.rssKb, done.hwmKb);
+
+    StageCounters& next = stages[static_cast<int>(stage)];
+    raisePeak(next.peakLive, liveBytes.load(std::memory_order_relaxed));
+    currentStage.store(static_cast<int>(stage), std::memory_order_relaxed);
+}
+
+void printMemStats() {
+    if (!g_memStats) return;
+    memStatsStage(MemStage::Other);  // samples the stage that was running
+
+    uint64_t allocs = 0;
+    uint64_t bytes = 0;
+    int64_t heapPeak = 0;
+    for (int i = 0; i < kStageCount; ++i) {
+        const StageCounters& stage = stages[i];
+        if (!stage.ran) continue;
+        uint64_t stageAllocs = stage.allocs.load(std::memory_order_relaxed);
+        uint64_t stageBytes = stage.bytes.load(std::memory_order_relaxed);
+        int64_t stagePeak = stage.peakLive.load(std::memory_order_relaxed);
+        allocs += stageAllocs;
+        bytes += stageBytes;
+        heapPeak = std::max(heapPeak, stagePeak);
+        printf("METRIC:Mem_%s_allocs:%llu\n", kStageNames[i], static_cast<unsigned long long>(stageAllocs));
+        printf("METRIC:Mem_%s_alloc_bytes:%llu\n", kStageNames[i], static_cast<unsigned long long>(stageBytes));
+        printf("METRIC:Mem_%s_heap_peak_bytes:%lld\n", kStageNames[i], static_cast<long long>(stagePeak));
+        printf("METRIC:Mem_%s_rss_kb:%ld\n", kStageNames[i], stage.rssKb);
+        printf("METRIC:Mem_%s_hwm_kb:%ld\n", kStageNames[i], stage.hwmKb);
+    }
+
+    long rssKb = -1;
+    long hwmKb = -1;
+    sampleRss(rssKb, hwmKb);
+    printf("METRIC:Mem_allocs:%llu\n", static_cast<unsigned long long>(allocs));
+    printf("METRIC:Mem_alloc_bytes:%llu\n", static_cast<unsigned long long>(bytes));
+    printf("METRIC:Mem_heap_peak_bytes:%lld\n", static_cast<long long>(heapPeak));
+    printf("METRIC:Mem_peak_rss_kb:%ld\n", hwmKb);
+}
+
+// ============================================================================
+// GLOBAL ALLOCATOR
+// ============================================================================
+
+void* operator new(std::size_t size) { return countedNew(size); }
+void* operator new[](std::size_t size) { return countedNew(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return countedAlignedNew(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return countedAlignedNew(size, alignment); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedNew(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedNew(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* buffer) noexcept { countedDelete(buffer); }
+void operator delete[](void* buffer) noexcept { countedDelete(buffer); }
+void operator delete(void* buffer, std::size_t) noexcept { countedDelete(buffer); }
+void operator delete[](void* buffer, std::size_t) noexcept { countedDelete(buffer); }
+void operator delete(void* buffer, std::align_val_t) noexcept { countedDelete(buffer); }
+void operator delete[](void* buffer, std::align_val_t) noexcept { countedDelete(buffer); }
+void operator delete(void* buffer, std::size_t, std::align_val_t) noexcept { countedDelete(buffer); }
+void operator delete[](void* buffer, std::size_t, std::align_val_t) noexcept { countedDelete(buffer); }
+void operator delete(void* buffer, const std::nothrow_t&) noexcept { countedDelete(buffer); }
+void operator delete[](void* buffer, const std::nothrow_t&) noexcept { countedDelete(buffer); }
@@ -0,0 +1,268 @@
+#include "../include/raw_loader.h"
+#include "../include/stream_loader.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ============================================================================
+// MAPPED FILE
+// ============================================================================
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& filepath) {
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    // Read-only: views over the mapping are never written to
+    size_t length = static_cast<size_t>(st.st_size);
+    void* base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) return nullptr;
+
+    madvise(base, length, MADV_SEQUENTIAL);
+    return std::shared_ptr<MappedFile>(new MappedFile(static_cast<const unsigned char*>(base), length));
+}
+
+MappedFile::~MappedFile() {
+    if (base != nullptr) {
+        munmap(const_cast<unsigned char*>(base), length);
+    }
+}
+
+// ============================================================================
+// Y4M
+// ============================================================================
+
+// Parse "YUV4MPEG2 W.. H.. C..." up to the end of the stream header line
+static bool parseY4mHeader(
+    const unsigned char* data,
+    size_t size,
+    int& width,
+    int& height,
+    int& shiftX,
+    int& shiftY,
+    bool& mono,
+    size_t& headerEnd
+) {
+    static const char magic[] = "YUV4MPEG2 ";
+    if (size < sizeof(magic) - 1 || std::memcmp(data, magic, sizeof(magic) - 1) != 0) return false;
+
+    const unsigned char* nl = static_cast<const unsigned char*>(std::memchr(data, '\n', std::min<size_t>(size, 4096)));
+    if (nl == nullptr) return false;
+
+    std::string header(reinterpret_cast<const char*>(data), nl - data);
+    headerEnd = static_cast<size_t>(nl - data) + 1;
+
+    width = height = 0;
+    shiftX = shiftY = 1;  // C420 is the default colorspace
+    mono = false;
+
+    size_t pos = 0;
+    while ((pos = header.find(' ', pos)) != std::string::npos) {
+        ++pos;
+        if (pos >= header.size()) break;
+        char tag = header[pos];
+        std::string value = header.substr(pos + 1, header.find(' ', pos) - pos - 1);
+        if (tag == 'W') {
+            width = std::atoi(value.c_str());
+        } else if (tag == 'H') {
+            height = std::atoi(value.c_str());
+        } else if (tag == 'C') {
+            // 8-bit layouts only; p10/p12/p16, mono16, 444alpha and 411 are rejected
+            if (value == "420" || value == "420jpeg" || value == "420mpeg2" || value == "420paldv") {
+                shiftX = 1; shiftY = 1;
+            } else if (value == "422") {
+                shiftX = 1; shiftY = 0;
+            } else if (value == "444") {
+                shiftX = 0; shiftY = 0;
+            } else if (value == "mono") {
+                mono = true;
+            } else {
+                return false;
+            }
+        }
+    }
+
+    return width > 0 && height > 0;
+}
+
+bool Y4mReader::open(const std::string& filepath) {
+    return open(MappedFile::open(filepath));
+}
+
+bool Y4mReader::open(std::shared_ptr<MappedFile> mapped) {
+    file = std::move(mapped);
+    if (!file) return false;
+
+    const unsigned char* data = file->data();
+    size_t size = file->size();
+    size_t pos = 0;
+    if (!parseY4mHeader(data, size, frameWidth, frameHeight, chromaShiftX, chromaShiftY, monochrome, pos)) {
+        file.reset();
+        return false;
+    }
+
+    size_t lumaBytes = static_cast<size_t>(frameWidth) * frameHeight;
+    size_t chromaBytes = monochrome ? 0
+        : static_cast<size_t>((frameWidth + (1 << chromaShiftX) - 1) >> chromaShiftX)
+        * static_cast<size_t>((frameHeight + (1 << chromaShiftY) - 1) >> chromaShiftY);
+    size_t frameBytes = lumaBytes + 2 * chromaBytes;
+
+    frameOffsets.clear();
+    while (pos + 5 <= size && std::memcmp(data + pos, "FRAME", 5) == 0) {
+        // Frame header may carry parameters; it always ends with '\n'
+        const unsigned char* nl = static_cast<const unsigned char*>(std::memchr(data + pos, '\n', size - pos));
+        if (nl == nullptr) break;
+        size_t payload = static_cast<size_t>(nl - data) + 1;
+        if (payload + frameBytes > size) break;  // truncated last frame
+        frameOffsets.push_back(payload);
+        pos = payload + frameBytes;
+    }
+
+    return !frameOffsets.empty();
+}
+
+Image Y4mReader::frame(int index, int desiredChannels) const {
+    Image img;
+    if (!file || index < 0 || index >= frameCount()) return img;
+
+    const unsigned char* luma = file->data() + frameOffsets[index];
+
+    if (desiredChannels == 0 && monochrome) {
+        // Zero-copy: the Y plane is already a packed 8-bit gray image
+        return Image::borrow(luma, frameWidth, frameHeight, 1, frameWidth, file);
+    }
+
+    // Gray output is the luma of the converted RGB (lumaByte), not the
+    // limited-range Y plane, so it matches what the RGB pipeline sees
+    int outChannels = desiredChannels == 1 ? 1 : (desiredChannels == 4 ? 4 : 3);
+    size_t total = static_cast<size_t>(frameWidth) * frameHeight;
+    img = Image::allocate(frameWidth, frameHeight, outChannels);
+    if (!img.isValid()) return img;
+
+    int chromaWidth = (frameWidth + (1 << chromaShiftX) - 1) >> chromaShiftX;
+    int chromaHeight = (frameHeight + (1 << chromaShiftY) - 1) >> chromaShiftY;
+    const unsigned char* planeU = luma + total;
+    const unsigned char* planeV = planeU + static_cast<size_t>(chromaWidth) * chromaHeight;
+
+    // BT.601 limited-range YCbCr -> RGB in 8.8 fixed point
+    auto clip = [](int v) { return static_cast<unsigned char>(std::max(0, std::min(255, v))); };
+    for (int y = 0; y < frameHeight; ++y) {
+        const unsigned char* rowY = luma + static_cast<size_t>(y) * frameWidth;
+        size_t chromaRow = static_cast<size_t>(y >> chromaShiftY) * chromaWidth;
+        unsigned char* out = img.row(y);
+        for (int x = 0; x < frameWidth; ++x) {
+            int c = 298 * (rowY[x] - 16);
+            int d = monochrome ? 0 : planeU[chromaRow + (x >> chromaShiftX)] - 128;
+            int e = monochrome ? 0 : planeV[chromaRow + (x >> chromaShiftX)] - 128;
+            unsigned char r = clip((c + 409 * e + 128) >> 8);
+            unsigned char g = clip((c - 100 * d - 208 * e + 128) >> 8);
+            unsigned char b = clip((c + 516 * d + 128) >> 8);
+            if (outChannels == 1) {
+                out[0] = lumaByte(r, g, b);
+            } else {
+                out[0] = r;
+                out[1] = g;
+                out[2] = b;
+                if (outChannels == 4) out[3] = 255;
+            }
+            out += outChannels;
+        }
+    }
+
+    return img;
+}
+
+// ============================================================================
+// RAW LOADER
+// ============================================================================
+
+bool RawLoader::isRawFormat(const std::string& filepath) {
+    FILE* f = std::fopen(filepath.c_str(), "rb");
+    if (f == nullptr) return false;
+
+    unsigned char head[4096];
+    size_t n = std::fread(head, 1, sizeof(head), f);
+    std::fclose(f);
+
+    PnmHeader pnm;
+    if (parsePnmHeader(head, n, pnm)) return true;
+
+    int w, h, sx, sy;
+    bool mono;
+    size_t end;
+    return parseY4mHeader(head, n, w, h, sx, sy, mono, end);
+}
+
+Image RawLoader::loadImage(const std::string& filepath, int desiredChannels) {
+    Image img;
+
+    std::shared_ptr<MappedFile> file = MappedFile::open(filepath);
+    if (!file) {
+        std::cerr << "Błąd: Nie można zmapować pliku: " << filepath << std::endl;
+        return img;
+    }
+
+    PnmHeader pnm;
+    if (!parsePnmHeader(file->data(), file->size(), pnm)) {
+        Y4mReader reader;
+        if (!reader.open(file)) {
+            std::cerr << "Błąd: Niepoprawny plik Y4M: " << filepath << std::endl;
+            return img;
+        }
+        img = reader.frame(0, desiredChannels);
+        std::cout << "Obraz wczytany pomyślnie (Y4M, ramek: " << reader.frameCount() << "):" << std::endl;
+    } else {
+        size_t payload = static_cast<size_t>(pnm.width) * pnm.height * pnm.channels;
+        if (pnm.dataOffset + payload > file->size()) {
+            std::cerr << "Błąd: Plik obrazu jest ucięty: " << filepath << std::endl;
+            return img;
+        }
+
+        const unsigned char* pixels = file->data() + pnm.dataOffset;
+        int outChannels = desiredChannels > 0 ? desiredChannels : pnm.channels;
+        if (outChannels == 1 && pnm.channels >= 3) {
+            // Reducing the mapped raster to luma would read the whole file up
+            // front; the color view is free and scaling only reads what it samples
+            outChannels = pnm.channels;
+        }
+
+        if (outChannels == pnm.channels) {
+            // Zero-copy view over the mapped raster
+            img = Image::borrow(pixels, pnm.width, pnm.height, outChannels, pnm.width * outChannels, file);
+            std::cout << "Obraz wczytany pomyślnie (mmap, bez kopiowania):" << std::endl;
+        } else {
+            if (outChannels != 1 && outChannels != 3 && outChannels != 4) {
+                std::cerr << "Błąd: Nieobsługiwana liczba kanałów: " << outChannels << std::endl;
+                return img;
+            }
+            img = Image::allocate(pnm.width, pnm.height, outChannels);
+            if (!img.isValid()) return img;
+            size_t rowIn = static_cast<size_t>(pnm.width) * pnm.channels;
+            for (int y = 0; y < pnm.height; ++y) {
+                convertPixelRow(pixels + y * rowIn, pnm.channels, false,
+                                img.row(y), outChannels, pnm.width);
+            }
+            std::cout << "Obraz wczytany pomyślnie (mmap, konwersja kanałów):" << std::endl;
+        }
+    }
+
+    if (img.isValid()) {
+        std::cout << "  Ścieżka: " << filepath << std::endl;
+        std::cout << "  Wymiary: " << img.width << "x" << img.height << std::endl;
+        std::cout << "  Kanały: " << img.channels << std::endl;
+    }
+
+    return img;
+}
@@ -0,0 +1,168 @@
+#include "../include/sequence_converter.h"
+#include <algorithm>
+#include <cstring>
+
+// Change-detection granularity, in scaled pixels (= output cells)
+static constexpr int kTemporalTileCols = 16;
+static constexpr int kTemporalTileRows = 8;
+
+// Largest raw magnitude over the inner pixels of a tile
+static float tileMaxGradient(const EdgeMap& gradients, int x0, int y0, int x1, int y1) {
+    x0 = std::max(1, x0);
+    y0 = std::max(1, y0);
+    x1 = std::min(gradients.width - 1, x1);
+    y1 = std::min(gradients.height - 1, y1);
+    float maxGradient = 0.0f;
+    for (int y = y0; y < y1; ++y) {
+        const float* row = gradients.magnitudes + static_cast<size_t>(y) * gradients.width;
+        for (int x = x0; x < x1; ++x) {
+            maxGradient = std::max(maxGradient, row[x]);
+        }
+    }
+    return maxGradient;
+}
+
+SequenceConverter::SequenceConverter(int targetWidth, int adjustedHeight, bool useEdges, bool useHsv)
+    : targetWidth(targetWidth)
+    , adjustedHeight(adjustedHeight)
+    , useEdges(useEdges)
+    , useHsv(useHsv)
+{
+}
+
+void SequenceConverter::reset(int w, int h) {
+    gridWidth = w;
+    gridHeight = h;
+    previous = Image();
+    gradients = EdgeMap(w, h);
+    edges = EdgeMap(w, h);
+    maxGradient = 0.0f;
+    ascii.assign(static_cast<size_t>(w) * h, AsciiPixel{' ', 0, 0, 0});
+
+    tiles.clear();
+    for (int y0 = 0; y0 < h; y0 += kTemporalTileRows) {
+        for (int x0 = 0; x0 < w; x0 += kTemporalTileCols) {
+            tiles.push_back({x0, y0, std::min(w, x0 + kTemporalTileCols), std::min(h, y0 + kTemporalTileRows), 0.0f});
+        }
+    }
+}
+
+// A tile is dirty when any pixel of it or its one-pixel halo changed
+bool SequenceConverter::tileChanged(const Image& scaled, const Tile& tile) const {
+    const int c = scaled.channels;
+    const int cx0 = std::max(0, tile.x0 - 1);
+    const int cx1 = std::min(gridWidth, tile.x1 + 1);
+    const size_t bytes = static_cast<size_t>(cx1 - cx0) * c;
+    for (int y = std::max(0, tile.y0 - 1); y < std::min(gridHeight, tile.y1 + 1); ++y) {
+        const size_t offset = static_cast<size_t>(cx0) * c;
+        if (std::memcmp(scaled.row(y) + offset, previous.row(y) + offset, bytes) != 0) return true;
+    }
+    return false;
+}
+
+// Same division detectEdgesSobel applies to the whole map
+void SequenceConverter::normalize(const Tile& tile) {
+    for (int y = std::max(1, tile.y0); y < std::min(gridHeight - 1, tile.y1); ++y) {
+        const size_t row = static_cast<size_t>(y) * gridWidth;
+        for (int x = std::max(1, tile.x0); x < std::min(gridWidth - 1, tile.x1); ++x) {
+            float magnitude = gradients.magnitudes[row + x];
+            edges.magnitudes[row + x] = maxGradient > 0.0f ? magnitude / maxGradient : magnitude;
+            edges.angles[row + x] = gradients.angles[row + x];
+        }
+    }
+}
+
+const std::vector<AsciiPixel>& SequenceConverter::convert(const Image& frame) {
+    Image scaled = scaleImage(frame, targetWidth, adjustedHeight, 1.0f);
+    if (!scaled.isValid()) {
+        ascii.clear();
+        return ascii;
+    }
+
+    const bool first = !previous.isValid() || scaled.width != gridWidth || scaled.height != gridHeight
+                    || scaled.channels != previous.channels;
+    if (first) reset(scaled.width, scaled.height);
+
+    std::vector<size_t> dirty;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        if (first || tileChanged(scaled, tiles[i])) dirty.push_back(i);
+    }
+    if (!first) {
+        dirtyTiles += dirty.size();
+        comparedTiles += tiles.size();
+    }
+
+    bool redrawAll = first;
+    const bool tiledEdges = useEdges && g_edgeMode == EdgeMode::Sobel;
+    if (useEdges && !tiledEdges && !dirty.empty()) {
+        // Hysteresis connects edges across the whole frame, so Canny is redone in full
+        edges = detectEdgesCanny(scaled, g_cannyLow, g_cannyHigh);
+        redrawAll = true;
+    }
+    if (tiledEdges && !dirty.empty()) {
+        if (sobelUsesAsm(scaled)) {
+            // The ASM kernel only runs on whole rows: redo every tile row
+            // holding a dirty tile (clean tiles in it come out unchanged)
+            std::vector<bool> bandDirty((gridHeight + kTemporalTileRows - 1) / kTemporalTileRows, false);
+            for (size_t i : dirty) bandDirty[tiles[i].y0 / kTemporalTileRows] = true;
+            for (size_t band = 0; band < bandDirty.size(); ++band) {
+                if (!bandDirty[band]) continue;
+                int y0 = static_cast<int>(band) * kTemporalTileRows;
+                sobelRegion(scaled, gradients, 0, y0, gridWidth, y0 + kTemporalTileRows);
+            }
+            for (size_t i : dirty) {
+                Tile& tile = tiles[i];
+                tile.maxGradient = tileMaxGradient(gradients, tile.x0, tile.y0, tile.x1, tile.y1);
+            }
+        } else {
+            for (size_t i : dirty) {
+                Tile& tile = tiles[i];
+                tile.maxGradient = sobelRegion(scaled, gradients, tile.x0, tile.y0, tile.x1, tile.y1);
+            }
+        }
+
+        // A new frame maximum changes every normalized magnitude
+        float frameMax = 0.0f;
+        for (const Tile& tile : tiles) frameMax = std::max(frameMax, tile.maxGradient);
+        if (frameMax != maxGradient) {
+            maxGradient = frameMax;
+            redrawAll = true;
+        }
+    }
+
+    // The levels table comes from the whole frame; when it moves, every glyph may change
+    LevelsLut frameLevels;
+    const bool useLevels = !useHsv && buildLevelsLut(scaled, g_levelsMode, frameLevels);
+    if (useLevels && frameLevels != levels) {
+        levels = frameLevels;
+        redrawAll = true;
+    }
+    const LevelsLut* levelSource = useLevels ? &levels : nullptr;
+
+    // Diffused error carries across tiles: any change redraws the frame
+    const bool dithered = g_ditherMode != DitherMode::None;
+    if (dithered && !dirty.empty()) redrawAll = true;
+
+    const EdgeMap* edgeSource = useEdges ? &edges : nullptr;
+    if (redrawAll) {
+        if (tiledEdges) {
+            for (const Tile& tile : tiles) normalize(tile);
+        }
+        if (dithered) {
+            convertToAscii(scaled, edgeSource, useEdges, useHsv, ascii.data());
+        } else {
+            convertToAsciiRegion(scaled, edgeSource, useEdges, useHsv, 0, 0, gridWidth, gridHeight, ascii,
+                                 levelSource);
+        }
+    } else {
+        for (size_t i : dirty) {
+            const Tile& tile = tiles[i];
+            if (tiledEdges) normalize(tile);
+            convertToAsciiRegion(scaled, edgeSource, useEdges, useHsv, tile.x0, tile.y0, tile.x1, tile.y1, ascii,
+                                 levelSource);
+        }
+    }
+
+    previous = std::move(scaled);
+    return ascii;
+}
@@ -0,0 +1,369 @@
+#include "../include/stream_loader.h"
+#include "../include/image_converter.h"
+#include "../external/stb_image.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// ============================================================================
+// PNM HEADER
+// ============================================================================
+
+// Skip whitespace and '#' comments, then read one decimal header field
+static bool readPnmField(const unsigned char* data, size_t size, size_t& pos, int& value) {
+    while (pos < size) {
+        if (data[pos] == '#') {
+            while (pos < size && data[pos] != '\n') ++pos;
+        } else if (data[pos] == ' ' || data[pos] == '\t' || data[pos] == '\r' || data[pos] == '\n') {
+            ++pos;
+        } else {
+            break;
+        }
+    }
+
+    if (pos >= size || data[pos] < '0' || data[pos] > '9') return false;
+
+    long v = 0;
+    while (pos < size && data[pos] >= '0' && data[pos] <= '9') {
+        v = v * 10 + (data[pos] - '0');
+        if (v > 1000000) return false;
+        ++pos;
+    }
+    value = static_cast<int>(v);
+    return true;
+}
+
+// PAM (P7) header: "KEY value" lines terminated by ENDHDR
+static bool parsePamHeader(const unsigned char* data, size_t size, PnmHeader& header) {
+    size_t pos = 2;
+    while (pos < size) {
+        size_t lineEnd = pos;
+        while (lineEnd < size && data[lineEnd] != '\n') ++lineEnd;
+        if (lineEnd >= size) return false;
+
+        std::string line(reinterpret_cast<const char*>(data + pos), lineEnd - pos);
+        pos = lineEnd + 1;
+
+        if (line.empty() || line[0] == '#') continue;
+        if (line.rfind("ENDHDR", 0) == 0) {
+            header.dataOffset = pos;
+            break;
+        }
+
+        size_t valuePos = line.find(' ');
+        if (valuePos == std::string::npos) continue;
+        std::string key = line.substr(0, valuePos);
+        if (key == "TUPLTYPE") continue;
+
+        int value = 0;
+        const auto* fields = reinterpret_cast<const unsigned char*>(line.data());
+        if (!readPnmField(fields, line.size(), valuePos, value)) return false;
+
+        if (key == "WIDTH") header.width = value;
+        else if (key == "HEIGHT") header.height = value;
+        else if (key == "DEPTH") header.channels = value;
+        else if (key == "MAXVAL") header.maxValue = value;
+    }
+
+    // GRAYSCALE, RGB and RGB_ALPHA tuples
+    bool depthOk = header.channels == 1 || header.channels == 3 || header.channels == 4;
+    return header.dataOffset > 0 && depthOk;
+}
+
+bool parsePnmHeader(const unsigned char* data, size_t size, PnmHeader& header) {
+    if (size < 3 || data[0] != 'P') return false;
+
+    if (data[1] == '7') {
+        if (!parsePamHeader(data, size, header)) return false;
+        return header.width > 0 && header.height > 0 && header.maxValue == 255;
+    }
+
+    if (data[1] != '5' && data[1] != '6') return false;
+
+    header.channels = (data[1] == '5') ? 1 : 3;
+    size_t pos = 2;
+    if (!readPnmField(data, size, pos, header.width)) return false;
+    if (!readPnmField(data, size, pos, header.height)) return false;
+    if (!readPnmField(data, size, pos, header.maxValue)) return false;
+
+    // Exactly one whitespace byte separates the header from the raster
+    if (pos >= size) return false;
+    header.dataOffset = pos + 1;
+
+    return header.width > 0 && header.height > 0 && header.maxValue == 255;
+}
+
+// ============================================================================
+// STREAMING SCALER
+// ============================================================================
+
+StreamingScaler::StreamingScaler(int srcWidth, int srcHeight, int channels, int targetWidth, int targetHeight)
+    : srcWidth(srcWidth)
+    , srcHeight(srcHeight)
+    , channels(channels)
+    , targetWidth(targetWidth)
+    , targetHeight(targetHeight)
+    , scaleY(static_cast<float>(srcHeight) / targetHeight)
+{
+    size_t rowBytes = static_cast<size_t>(srcWidth) * channels;
+    prevRow.resize(rowBytes);
+    curRow.resize(rowBytes);
+
+    // Rows never reached by the input stay black; rows are padded like scaleImage's
+    dst = Image::allocate(targetWidth, targetHeight, channels, ImageStorage::Aligned);
+    if (dst.isValid()) {
+        std::memset(dst.data, 0, static_cast<size_t>(dst.stride) * dst.height);
+    }
+}
+
+void StreamingScaler::pushRow(const unsigned char* row) {
+    if (rowsPushed >= srcHeight || dst.data == nullptr) return;
+
+    std::swap(prevRow, curRow);
+    std::memcpy(curRow.data(), row, curRow.size());
+    ++rowsPushed;
+
+    emitReadyRows();
+}
+
+void StreamingScaler::emitReadyRows() {
+    while (nextOutputRow < targetHeight) {
+        float srcY = nextOutputRow * scaleY;
+
+        // Same rule as scaleImage: rows past the last source pair stay black
+        if (srcY >= srcHeight - 1) {
+            ++nextOutputRow;
+            continue;
+        }
+
+        int y0 = static_cast<int>(srcY);
+        y0 = std::max(0, std::min(y0, srcHeight - 2));
+
+        // Need source rows y0 and y0 + 1, i.e. curRow must be row y0 + 1
+        if (y0 + 1 != rowsPushed - 1) break;
+
+        float fy = srcY - y0;
+        fy = std::max(0.0f, std::min(1.0f, fy));
+
+        scaleRowBilinear(
+            prevRow.data(), curRow.data(), srcWidth, channels, fy,
+            dst.row(nextOutputRow), targetWidth
+        );
+        ++nextOutputRow;
+    }
+}
+
+size_t StreamingScaler::memoryFootprint() const {
+    return prevRow.size() + curRow.size()
+         + static_cast<size_t>(targetWidth) * targetHeight * channels;
+}
+
+Image StreamingScaler::finish() {
+    return std::move(dst);
+}
+
+// ============================================================================
+// ROW READERS
+// ============================================================================
+
+void convertPixelRow(
+    const unsigned char* src,
+    int srcChannels,
+    bool bgr,
+    unsigned char* dst,
+    int dstChannels,
+    int width
+) {
+    for (int x = 0; x < width; ++x) {
+        const unsigned char* p = src + x * srcChannels;
+        unsigned char r, g, b;
+        unsigned char a = (srcChannels == 4) ? p[3] : 255;
+        if (srcChannels == 1) {
+            r = g = b = p[0];
+        } else if (bgr) {
+            r = p[2]; g = p[1]; b = p[0];
+        } else {
+            r = p[0]; g = p[1]; b = p[2];
+        }
+
+        unsigned char* q = dst + x * dstChannels;
+        if (dstChannels == 1) {
+            q[0] = lumaByte(r, g, b);
+        } else {
+            q[0] = r;
+            q[1] = g;
+            q[2] = b;
+            if (dstChannels == 4) q[3] = a;
+        }
+    }
+}
+
+namespace {
+
+struct FileCloser {
+    void operator()(FILE* f) const { if (f) std::fclose(f); }
+};
+using FilePtr = std::unique_ptr<FILE, FileCloser>;
+
+enum class StreamFormat { None, Pnm, Bmp };
+
+struct StreamSource {
+    StreamFormat format = StreamFormat::None;
+    int width = 0;
+    int height = 0;
+    int channels = 0;         // channels stored in the file
+    size_t dataOffset = 0;
+    size_t fileRowBytes = 0;  // including BMP row padding
+    bool bottomUp = false;    // BMP default row order
+};
+
+uint32_t readLE32(const unsigned char* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint16_t readLE16(const unsigned char* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+bool probeStreamSource(FILE* f, StreamSource& src) {
+    unsigned char head[512];
+    size_t n = std::fread(head, 1, sizeof(head), f);
+
+    PnmHeader pnm;
+    if (parsePnmHeader(head, n, pnm)) {
+        src.format = StreamFormat::Pnm;
+        src.width = pnm.width;
+        src.height = pnm.height;
+        src.channels = pnm.channels;
+        src.dataOffset = pnm.dataOffset;
+        src.fileRowBytes = static_cast<size_t>(pnm.width) * pnm.channels;
+        return true;
+    }
+
+    // Uncompressed 24/32-bit BMP (BI_RGB)
+    if (n >= 54 && head[0] == 'B' && head[1] == 'M') {
+        uint32_t offset = readLE32(head + 10);
+        int32_t width = static_cast<int32_t>(readLE32(head + 18));
+        int32_t height = static_cast<int32_t>(readLE32(head + 22));
+        uint16_t bpp = readLE16(head + 28);
+        uint32_t compression = readLE32(head + 30);
+
+        if (compression != 0 || (bpp != 24 && bpp != 32) || width <= 0 || height == 0) return false;
+
+        src.format = StreamFormat::Bmp;
+        src.width = width;
+        src.height = height > 0 ? height : -height;
+        src.bottomUp = height > 0;
+        src.channels = bpp / 8;
+        src.dataOffset = offset;
+        src.fileRowBytes = ((static_cast<size_t>(bpp) * width + 31) / 32) * 4;
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace
+
+// ============================================================================
+// STREAMING LOADER
+// ============================================================================
+
+bool StreamingLoader::canStream(const std::string& filepath) {
+    FilePtr f(std::fopen(filepath.c_str(), "rb"));
+    if (!f) return false;
+    StreamSource src;
+    return probeStreamSource(f.get(), src);
+}
+
+size_t StreamingLoader::estimateDecodeBytes(const std::string& filepath, int desiredChannels) {
+    int w = 0, h = 0, comp = 0;
+    if (!stbi_info(filepath.c_str(), &w, &h, &comp)) return 0;
+    int channels = desiredChannels > 0 ? desiredChannels : comp;
+    return static_cast<size_t>(w) * static_cast<size_t>(h) * static_cast<size_t>(channels);
+}
+
+Image StreamingLoader::loadScaled(
+    const std::string& filepath,
+    int targetWidth,
+    int targetHeight,
+    int desiredChannels,
+    size_t memoryCapBytes,
+    size_t* peakBytes
+) {
+    FilePtr f(std::fopen(filepath.c_str(), "rb"));
+    if (!f) {
+        std::cerr << "Błąd: Plik nie istnieje: " << filepath << std::endl;
+        return Image();
+    }
+
+    StreamSource src;
+    if (!probeStreamSource(f.get(), src)) {
+        f.reset();
+
+        // No row-level access (JPEG, PNG, ...): full decode, but only within the cap
+        size_t decodeBytes = estimateDecodeBytes(filepath, desiredChannels);
+        size_t outBytes = static_cast<size_t>(targetWidth) * targetHeight * std::max(1, desiredChannels);
+        if (memoryCapBytes > 0 && decodeBytes + outBytes > memoryCapBytes) {
+            std::cerr << "Błąd: Format nie obsługuje dekodowania strumieniowego, a pełne dekodowanie wymaga "
+                      << (decodeBytes + outBytes) / (1024 * 1024) << " MB (limit: "
+                      << memoryCapBytes / (1024 * 1024) << " MB)" << std::endl;
+            return Image();
+        }
+
+        Image full = ImageLoader::loadImage(filepath, desiredChannels);
+        if (peakBytes) *peakBytes = decodeBytes + outBytes;
+        return scaleImage(full, targetWidth, targetHeight, 1.0f);
+    }
+
+    int outChannels = desiredChannels > 0 ? desiredChannels : (src.channels == 1 ? 1 : 3);
+    if (outChannels != 1 && outChannels != 3) {
+        std::cerr << "Błąd: Nieobsługiwana liczba kanałów: " << outChannels << std::endl;
+        return Image();
+    }
+
+    StreamingScaler scaler(src.width, src.height, outChannels, targetWidth, targetHeight);
+    std::vector<unsigned char> fileRow(src.fileRowBytes);
+    std::vector<unsigned char> row(static_cast<size_t>(src.width) * outChannels);
+
+    size_t peak = scaler.memoryFootprint() + fileRow.size() + row.size();
+    if (peakBytes) *peakBytes = peak;
+    if (memoryCapBytes > 0 && peak > memoryCapBytes) {
+        std::cerr << "Błąd: Dekodowanie strumieniowe wymaga " << peak / 1024
+                  << " KB (limit: " << memoryCapBytes / 1024 << " KB)" << std::endl;
+        return Image();
+    }
+
+    bool bgr = src.format == StreamFormat::Bmp;
+    if (!src.bottomUp) {
+        fseeko(f.get(), static_cast<off_t>(src.dataOffset), SEEK_SET);
+    }
+
+    for (int y = 0; y < src.height; ++y) {
+        if (src.bottomUp) {
+            // Bottom-up BMP: seek to each row so rows still arrive top-to-bottom
+            size_t fileRowIndex = static_cast<size_t>(src.height - 1 - y);
+            fseeko(f.get(), static_cast<off_t>(src.dataOffset + fileRowIndex * src.fileRowBytes), SEEK_SET);
+        }
+
+        if (std::fread(fileRow.data(), 1, fileRow.size(), f.get()) != fileRow.size()) {
+            std::cerr << "Błąd: Plik obrazu jest ucięty w wierszu " << y << ": " << filepath << std::endl;
+            return Image();
+        }
+
+        convertPixelRow(fileRow.data(), src.channels, bgr, row.data(), outChannels, src.width);
+        scaler.pushRow(row.data());
+    }
+
+    std::cout << "Obraz wczytany strumieniowo:" << std::endl;
+    std::cout << "  Ścieżka: " << filepath << std::endl;
+    std::cout << "  Wymiary źródła: " << src.width << "x" << src.height << std::endl;
+    std::cout << "  Wiersze: " << scaler.rowsConsumed() << std::endl;
+
+    return scaler.finish();
+}
@@ -0,0 +1,426 @@
+#include "../include/terminal_viewer.h"
+#include "../include/image_converter.h"
+#include "../include/image_pyramid.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+volatile sig_atomic_t g_terminalResized = 0;
+volatile sig_atomic_t g_viewerStop = 0;
+
+void onWindowChange(int) {
+    g_terminalResized = 1;
+}
+
+// SIGTERM/SIGHUP end the loop, so the terminal is restored on the way out
+void onStopSignal(int) {
+    g_viewerStop = 1;
+}
+
+// ============================================================================
+// TERMINAL
+// ============================================================================
+
+// Raw, non-echoing input on the alternate screen; restored on destruction.
+// ISIG is off so Ctrl+C arrives as a key (0x03) and quits through the loop
+// instead of killing the process with the terminal still raw.
+class RawTerminal {
+public:
+    RawTerminal() {
+        if (tcgetattr(STDIN_FILENO, &saved) != 0) return;
+
+        termios raw = saved;
+        raw.c_lflag &= ~(ICANON | ECHO | ISIG);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) != 0) return;
+
+        active = true;
+        writeAll("\033[?1049h\033[?25l\033[2J");
+    }
+
+    ~RawTerminal() {
+        if (!active) return;
+        writeAll("\033[0m\033[?25h\033[?1049l");
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    }
+
+    RawTerminal(const RawTerminal&) = delete;
+    RawTerminal& operator=(const RawTerminal&) = delete;
+
+    [[nodiscard]] bool isActive() const { return active; }
+
+    static void writeAll(const std::string& s) {
+        size_t off = 0;
+        while (off < s.size()) {
+            ssize_t n = ::write(STDOUT_FILENO, s.data() + off, s.size() - off);
+            if (n <= 0) return;
+            off += static_cast<size_t>(n);
+        }
+    }
+
+    static void querySize(int& cols, int& rows) {
+        winsize ws{};
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0 && ws.ws_row > 0) {
+            cols = ws.ws_col;
+            rows = ws.ws_row;
+        } else {
+            cols = 80;
+            rows = 24;
+        }
+    }
+
+private:
+    termios saved{};
+    bool active = false;
+};
+
+// ============================================================================
+// TILE CACHE
+// ============================================================================
+
+using Tile = std::vector<AsciiPixel>;
+
+// Least-recently-used cache of converted glyph tiles
+class TileCache {
+public:
+    explicit TileCache(size_t capacity) : capacity(std::max<size_t>(1, capacity)) {}
+
+    const Tile* find(uint64_t key) {
+        auto it = index.find(key);
+        if (it == index.end()) return nullptr;
+        entries.splice(entries.begin(), entries, it->second);
+        return &it->second->second;
+    }
+
+    const Tile& insert(uint64_t key, Tile&& tile) {
+        entries.emplace_front(key, std::move(tile));
+        index[key] = entries.begin();
+        while (entries.size() > capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        return entries.front().second;
+    }
+
+    void reserve(size_t minimum) { capacity = std::max(capacity, minimum); }
+    [[nodiscard]] size_t size() const { return entries.size(); }
+
+private:
+    size_t capacity;
+    std::list<std::pair<uint64_t, Tile>> entries;  // front = most recently used
+    std::unordered_map<uint64_t, std::list<std::pair<uint64_t, Tile>>::iterator> index;
+};
+
+uint64_t tileKey(int level, int tileX, int tileY) {
+    return (static_cast<uint64_t>(level) << 56)
+         | (static_cast<uint64_t>(static_cast<uint32_t>(tileY)) << 28)
+         | static_cast<uint64_t>(static_cast<uint32_t>(tileX));
+}
+
+// Length of the key at the start of buf: one byte, or a whole CSI/SS3 escape
+// sequence. A lone ESC at the end of the buffer is the Esc key itself.
+size_t keyLength(const char* buf, size_t n) {
+    if (buf[0] != '\033' || n == 1) return 1;
+    if (buf[1] == 'O') return std::min<size_t>(3, n);  // SS3: ESC O <final>
+    if (buf[1] != '[') return 1;
+    size_t i = 2;
+    while (i < n && !(buf[i] >= 0x40 && buf[i] <= 0x7e)) ++i;  // parameters up to the final byte
+    return std::min(i + 1, n);
+}
+
+// One terminal cell covers 1x2 pixels of a pyramid level (cells are ~2x taller than wide)
+int cellRows(const Image& level) {
+    return (level.height + 1) / 2;
+}
+
+// Convert one tile of a level: crop with a 1-cell halo so Sobel sees the
+// neighbours, run the regular edge + ASCII stages, keep the interior.
+Tile renderTile(const Image& level, int tileX, int tileY, const ViewerOptions& options) {
+    const int halo = 1;
+    const int cropW = options.tileCols + 2 * halo;
+    const int cropH = options.tileRows + 2 * halo;
+    const int cellX0 = tileX * options.tileCols - halo;
+    const int cellY0 = tileY * options.tileRows - halo;
+    const int c = level.channels;
+
+    Image crop = Image::allocate(cropW, cropH, c);
+    if (!crop.isValid()) return Tile(static_cast<size_t>(options.tileCols) * options.tileRows);
+    std::memset(crop.data, 0, static_cast<size_t>(crop.stride) * cropH);
+
+    for (int j = 0; j < cropH; ++j) {
+        int py = (cellY0 + j) * 2;
+        if (py < 0 || py >= level.height) continue;
+        int py1 = std::min(py + 1, level.height - 1);
+        const unsigned char* row0 = level.row(py);
+        const unsigned char* row1 = level.row(py1);
+
+        for (int i = 0; i < cropW; ++i) {
+            int px = cellX0 + i;
+            if (px < 0 || px >= level.width) continue;
+            unsigned char* out = crop.row(j) + i * c;
+            for (int ch = 0; ch < c; ++ch) {
+                out[ch] = static_cast<unsigned char>((row0[px * c + ch] + row1[px * c + ch] + 1) / 2);
+            }
+        }
+    }
+
+    std::vector<AsciiPixel> ascii;
+    if (options.useEdges) {
+        EdgeMap edges = detectEdges(crop);
+        ascii = convertToAscii(crop, &edges, true, options.useHsv);
+    } else {
+        ascii = convertToAscii(crop, nullptr, false, options.useHsv);
+    }
+
+    Tile tile(static_cast<size_t>(options.tileCols) * options.tileRows);
+    for (int j = 0; j < options.tileRows; ++j) {
+        for (int i = 0; i < options.tileCols; ++i) {
+            tile[j * options.tileCols + i] = ascii[(j + halo) * cropW + (i + halo)];
+        }
+    }
+    return tile;
+}
+
+// Format one screen row, emitting a color escape only when the color changes
+std::string formatRow(const AsciiPixel* row, int cols, bool useColors) {
+    std::string line;
+    line.reserve(static_cast<size_t>(cols) * (useColors ? 20 : 1));
+    int lastR = -1, lastG = -1, lastB = -1;
+    char buf[32];
+    for (int x = 0; x < cols; ++x) {
+        const AsciiPixel& p = row[x];
+        if (useColors && (p.r != lastR || p.g != lastG || p.b != lastB)) {
+            int n = std::snprintf(buf, sizeof(buf), "\033[38;2;%d;%d;%dm", p.r, p.g, p.b);
+            line.append(buf, n);
+            lastR = p.r; lastG = p.g; lastB = p.b;
+        }
+        line.push_back(p.character);
+    }
+    if (useColors) line += "\033[0m";
+    return line;
+}
+
+} // namespace
+
+// ============================================================================
+// VIEWER LOOP
+// ============================================================================
+
+int runViewer(Image&& image, const ViewerOptions& options) {
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO)) {
+        std::cerr << "[ERROR] --view requires an interactive terminal" << std::endl;
+        return 1;
+    }
+    if (!image.isValid() || options.tileCols <= 0 || options.tileRows <= 0) {
+        std::cerr << "[ERROR] Nothing to view" << std::endl;
+        return 1;
+    }
+
+    ImagePyramid pyramid = buildPyramid(std::move(image), 8, 8);
+    const int levelCount = static_cast<int>(pyramid.levels.size());
+
+    TileCache cache(options.maxCachedTiles);
+
+    struct sigaction sa{};
+    sa.sa_handler = onWindowChange;
+    sigemptyset(&sa.sa_mask);
+    struct sigaction previous{};
+    sigaction(SIGWINCH, &sa, &previous);
+
+    struct sigaction stop{};
+    stop.sa_handler = onStopSignal;
+    sigemptyset(&stop.sa_mask);
+    struct sigaction previousTerm{};
+    struct sigaction previousHup{};
+    sigaction(SIGTERM, &stop, &previousTerm);
+    sigaction(SIGHUP, &stop, &previousHup);
+    g_viewerStop = 0;
+
+    auto restoreSignals = [&]() {
+        sigaction(SIGWINCH, &previous, nullptr);
+        sigaction(SIGTERM, &previousTerm, nullptr);
+        sigaction(SIGHUP, &previousHup, nullptr);
+    };
+
+    int cols = 80, rows = 24;
+    RawTerminal::querySize(cols, rows);
+
+    // Start on the largest level that fits on screen
+    auto fittingLevel = [&]() {
+        for (int i = 0; i < levelCount; ++i) {
+            const Image& l = pyramid.levels[i];
+            if (l.width <= cols && cellRows(l) <= rows - 1) return i;
+        }
+        return levelCount - 1;
+    };
+
+    int level = fittingLevel();
+    int originX = 0;  // top-left visible cell of the current level
+    int originY = 0;
+
+    RawTerminal terminal;
+    if (!terminal.isActive()) {
+        restoreSignals();
+        std::cerr << "[ERROR] Unable to switch terminal to raw mode" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> shownRows;
+    std::vector<AsciiPixel> frame;
+    bool running = true;
+    bool dirty = true;
+
+    while (running && !g_viewerStop) {
+        if (g_terminalResized) {
+            g_terminalResized = 0;
+            RawTerminal::querySize(cols, rows);
+            shownRows.clear();
+            RawTerminal::writeAll("\033[2J");
+            dirty = true;
+        }
+
+        if (dirty) {
+            auto frameStart = std::chrono::high_resolution_clock::now();
+            const Image& img = pyramid.levels[level];
+            const int viewRows = std::max(1, rows - 1);
+            const int levelCellsW = img.width;
+            const int levelCellsH = cellRows(img);
+
+            originX = std::max(0, std::min(originX, levelCellsW - cols));
+            originY = std::max(0, std::min(originY, levelCellsH - viewRows));
+
+            // Visible tile range; cache must hold at least one screen of tiles
+            int tx0 = originX / options.tileCols;
+            int ty0 = originY / options.tileRows;
+            int tx1 = (originX + cols - 1) / options.tileCols;
+            int ty1 = (originY + viewRows - 1) / options.tileRows;
+            cache.reserve(static_cast<size_t>(tx1 - tx0 + 1) * (ty1 - ty0 + 1) * 2);
+
+            frame.assign(static_cast<size_t>(cols) * viewRows, AsciiPixel{' ', 0, 0, 0});
+            int newTiles = 0;
+
+            for (int ty = ty0; ty <= ty1; ++ty) {
+                for (int tx = tx0; tx <= tx1; ++tx) {
+                    uint64_t key = tileKey(level, tx, ty);
+                    const Tile* tile = cache.find(key);
+                    if (tile == nullptr) {
+                        tile = &cache.insert(key, renderTile(img, tx, ty, options));
+                        ++newTiles;
+                    }
+
+                    // Blit the visible part of the tile into the frame
+                    for (int j = 0; j < options.tileRows; ++j) {
+                        int sy = ty * options.tileRows + j - originY;
+                        int cy = ty * options.tileRows + j;
+                        if (sy < 0 || sy >= viewRows || cy >= levelCellsH) continue;
+                        for (int i = 0; i < options.tileCols; ++i) {
+                            int sx = tx * options.tileCols + i - originX;
+                            int cx = tx * options.tileCols + i;
+                            if (sx < 0 || sx >= cols || cx >= levelCellsW) continue;
+                            frame[static_cast<size_t>(sy) * cols + sx] = (*tile)[j * options.tileCols + i];
+                        }
+                    }
+                }
+            }
+
+            // Repaint only the rows that changed since the last frame
+            std::string out;
+            shownRows.resize(viewRows);
+            for (int y = 0; y < viewRows; ++y) {
+                std::string line = formatRow(&frame[static_cast<size_t>(y) * cols], cols, options.useColors);
+                if (line == shownRows[y]) continue;
+                out += "\033[" + std::to_string(y + 1) + ";1H";
+                out += line;
+                shownRows[y] = std::move(line);
+            }
+
+            double frameMs = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+                std::chrono::high_resolution_clock::now() - frameStart).count();
+
+            char status[256];
+            std::snprintf(status, sizeof(status),
+                          " level %d/%d %dx%d | at %d,%d | tiles +%d (%zu cached) | %.2f ms | arrows/hjkl +/- 0 q",
+                          level, levelCount - 1, img.width, img.height, originX, originY,
+                          newTiles, cache.size(), frameMs);
+            std::string statusLine(status);
+            statusLine.resize(static_cast<size_t>(cols), ' ');
+            out += "\033[" + std::to_string(rows) + ";1H\033[7m" + statusLine + "\033[0m";
+
+            RawTerminal::writeAll(out);
+            dirty = false;
+        }
+
+        pollfd pfd{STDIN_FILENO, POLLIN, 0};
+        int ready = poll(&pfd, 1, 250);
+        if (ready <= 0) continue;  // timeout or EINTR from SIGWINCH/SIGTERM
+
+        char keys[64];
+        ssize_t n = ::read(STDIN_FILENO, keys, sizeof(keys));
+        if (n <= 0) continue;
+
+        const int viewRows = std::max(1, rows - 1);
+        const int stepX = std::max(1, cols / 8);
+        const int stepY = std::max(1, viewRows / 8);
+
+        // One read can carry several keys (held arrows, pasted input): handle each
+        for (size_t off = 0; off < static_cast<size_t>(n) && running; ) {
+            size_t len = keyLength(keys + off, static_cast<size_t>(n) - off);
+            std::string seq(keys + off, len);
+            off += len;
+
+            if (seq == "q" || seq == "Q" || seq == "\033" || seq == "\x03") {
+                running = false;
+            } else if (seq == "\033[A" || seq == "\033OA" || seq == "k") {
+                originY -= stepY;
+            } else if (seq == "\033[B" || seq == "\033OB" || seq == "j") {
+                originY += stepY;
+            } else if (seq == "\033[D" || seq == "\033OD" || seq == "h") {
+                originX -= stepX;
+            } else if (seq == "\033[C" || seq == "\033OC" || seq == "l") {
+                originX += stepX;
+            } else if (seq == "\033[5~" || seq == "K") {
+                originY -= viewRows;
+            } else if (seq == "\033[6~" || seq == "J") {
+                originY += viewRows;
+            } else if (seq == "H") {
+                originX -= cols;
+            } else if (seq == "L") {
+                originX += cols;
+            } else if ((seq == "+" || seq == "=") && level > 0) {
+                // Zoom in around the screen centre
+                originX = (originX + cols / 2) * 2 - cols / 2;
+                originY = (originY + viewRows / 2) * 2 - viewRows / 2;
+                --level;
+            } else if ((seq == "-" || seq == "_") && level < levelCount - 1) {
+                originX = (originX + cols / 2) / 2 - cols / 2;
+                originY = (originY + viewRows / 2) / 2 - viewRows / 2;
+                ++level;
+            } else if (seq == "0") {
+                level = fittingLevel();
+                originX = 0;
+                originY = 0;
+            } else {
+                continue;
+            }
+            dirty = true;
+        }
+    }
+
+    restoreSignals();
+    return 0;
+}
@@ -0,0 +1,267 @@
+#include "../include/watch_mode.h"
+#include "../include/glyph_masks.h"
+#include "../include/image_converter.h"
+#include "../include/image_loader.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// The watcher is built on inotify; CMake defines HAVE_SYS_INOTIFY_H where the
+// header exists. Elsewhere (macOS) --watch reports that it is unavailable.
+#if defined(__linux__) && defined(HAVE_SYS_INOTIFY_H)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+volatile sig_atomic_t g_watchStop = 0;
+
+void onStopSignal(int) {
+    g_watchStop = 1;
+}
+
+struct WatchJob {
+    std::string path;
+    std::string name;
+    Clock::time_point queuedAt;
+};
+
+// Queue shared by the inotify reader and the converter pool
+class JobQueue {
+public:
+    void push(WatchJob job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        ready.notify_one();
+    }
+
+    // Blocks until a job is available; false once closed and drained
+    bool pop(WatchJob& job) {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] { return closed || !jobs.empty(); });
+        if (jobs.empty()) return false;
+        job = std::move(jobs.front());
+        jobs.pop_front();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<WatchJob> jobs;
+    bool closed = false;
+};
+
+const char* outputExtension(ExportFormat format) {
+    switch (format) {
+        case ExportFormat::Html: return ".html";
+        case ExportFormat::Svg: return ".svg";
+        default: return ".txt";
+    }
+}
+
+// Our own outputs (and editor/partial files) must not be fed back in
+bool shouldIgnore(const std::string& name) {
+    if (name.empty() || name[0] == '.') return true;
+    for (const char* ext : {".txt", ".html", ".svg", ".tmp", ".part"}) {
+        size_t n = std::char_traits<char>::length(ext);
+        if (name.size() >= n && name.compare(name.size() - n, n, ext) == 0) return true;
+    }
+    return false;
+}
+
+bool convertFile(const WatchJob& job, const WatchOptions& options, const std::string& outPath) {
+    const int channels = pipelineChannels(options.useColors, options.useHsv);
+    Image img;
+    const bool structureGlyphs = g_glyphMode == GlyphMode::Structure;
+    if (options.thumbnails) {
+        // Shape matching needs kGlyphCols x kGlyphRows pixels per cell
+        img = ImageLoader::loadThumbnail(job.path,
+                                         options.targetWidth * (structureGlyphs ? kGlyphCols : 1),
+                                         options.adjustedHeight * (structureGlyphs ? kGlyphRows : 1), channels);
+    }
+    if (!img.isValid()) img = ImageLoader::loadImage(job.path, channels);
+    if (!img.isValid()) return false;
+
+    Image scaled = scaleImage(img, options.targetWidth, options.adjustedHeight, 1.0f);
+    if (!scaled.isValid()) return false;
+
+    // Each warm worker keeps its grid between files
+    thread_local std::vector<AsciiPixel> ascii;
+    ascii.resize(static_cast<size_t>(scaled.width) * scaled.height);
+    if (options.useEdges) {
+        EdgeMap edges = detectEdges(scaled);
+        convertToAscii(scaled, &edges, true, options.useHsv, ascii.data());
+    } else {
+        convertToAscii(scaled, nullptr, false, options.useHsv, ascii.data());
+    }
+    if (structureGlyphs) {
+        matchGlyphStructure(img, scaled.width, scaled.height, ascii.data());
+    }
+
+    // Write under a temporary name, then rename into place
+    std::string tmpPath = outPath + ".tmp";
+    bool ok;
+    if (options.exportOptions.format == ExportFormat::Ansi) {
+        std::ofstream out(tmpPath, std::ios::binary);
+        writeAsciiArt(out, ascii, scaled.width, scaled.height, options.useColors);
+        ok = static_cast<bool>(out);
+    } else {
+        FILE* out = std::fopen(tmpPath.c_str(), "wb");
+        if (out == nullptr) return false;
+        ExportOptions exportOptions = options.exportOptions;
+        exportOptions.useColors = options.useColors;
+        ok = exportAscii(ascii, scaled.width, scaled.height, exportOptions, out) > 0;
+        ok = std::fclose(out) == 0 && ok;
+    }
+
+    if (!ok || std::rename(tmpPath.c_str(), outPath.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t idx = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[std::min(idx, values.size() - 1)];
+}
+
+} // namespace
+
+int runWatch(const WatchOptions& options) {
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "[ERROR] inotify_init1 failed" << std::endl;
+        return 1;
+    }
+    if (inotify_add_watch(fd, options.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cerr << "[ERROR] Cannot watch directory: " << options.directory << std::endl;
+        ::close(fd);
+        return 1;
+    }
+
+    const std::string outDir = options.outputDirectory.empty() ? options.directory : options.outputDirectory;
+    int workerCount = options.workers > 0
+        ? options.workers
+        : std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 2);
+
+    struct sigaction sa{};
+    sa.sa_handler = onStopSignal;
+    sigemptyset(&sa.sa_mask);
+    struct sigaction previousInt{};
+    struct sigaction previousTerm{};
+    sigaction(SIGINT, &sa, &previousInt);
+    sigaction(SIGTERM, &sa, &previousTerm);
+    g_watchStop = 0;
+
+    JobQueue queue;
+    std::mutex reportMutex;
+    std::vector<double> latencies;
+    int failures = 0;
+    int queued = 0;
+
+    // Warm pool: threads live for the whole watch session
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i) {
+        workers.emplace_back([&]() {
+            // Files are converted in parallel; the stages of one file stay on its worker
+            g_frameWorker = true;
+            WatchJob job;
+            while (queue.pop(job)) {
+                // Keep the input extension: a.jpg and a.png must not share a.txt
+                std::string outPath = outDir + "/" + job.name + outputExtension(options.exportOptions.format);
+                bool ok = convertFile(job, options, outPath);
+                double ms = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+                    Clock::now() - job.queuedAt).count();
+
+                std::lock_guard<std::mutex> lock(reportMutex);
+                if (ok) {
+                    latencies.push_back(ms);
+                    std::cout << "[watch] " << job.name << " -> " << outPath << " (" << ms << " ms)" << std::endl;
+                    printf("METRIC:Watch_file_ms:%.6f\n", ms);
+                    std::fflush(stdout);
+                } else {
+                    ++failures;
+                    std::cerr << "[watch] Failed to convert " << job.path << std::endl;
+                }
+            }
+        });
+    }
+
+    std::cout << "[watch] Watching " << options.directory << " with " << workerCount
+              << " worker(s); Ctrl+C to stop" << std::endl;
+
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (!g_watchStop && (options.fileLimit <= 0 || queued < options.fileLimit)) {
+        pollfd pfd{fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, 200);
+        if (ready <= 0) continue;
+
+        Clock::time_point now = Clock::now();
+        ssize_t len;
+        while ((len = ::read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + len; ) {
+                auto* event = reinterpret_cast<inotify_event*>(p);
+                p += sizeof(inotify_event) + event->len;
+                if (event->len == 0 || (event->mask & IN_ISDIR)) continue;
+
+                std::string name = event->name;
+                if (shouldIgnore(name)) continue;
+                if (options.fileLimit > 0 && queued >= options.fileLimit) continue;
+
+                queue.push({options.directory + "/" + name, name, now});
+                ++queued;
+            }
+        }
+    }
+
+    queue.close();
+    for (auto& th : workers) th.join();
+    ::close(fd);
+    sigaction(SIGINT, &previousInt, nullptr);
+    sigaction(SIGTERM, &previousTerm, nullptr);
+
+    std::cout << "[watch] Converted " << latencies.size() << " file(s), " << failures << " failed" << std::endl;
+    printf("METRIC:Watch_files:%zu\n", latencies.size());
+    printf("METRIC:Watch_failures:%d\n", failures);
+    printf("METRIC:Watch_latency_p50_ms:%.6f\n", percentile(latencies, 0.50));
+    printf("METRIC:Watch_latency_p95_ms:%.6f\n", percentile(latencies, 0.95));
+    printf("METRIC:Watch_latency_max_ms:%.6f\n",
+           latencies.empty() ? 0.0 : *std::max_element(latencies.begin(), latencies.end()));
+    return failures == 0 ? 0 : 1;
+}
+
+#else
+
+int runWatch(const WatchOptions& options) {
+    std::cerr << "[ERROR] --watch needs inotify (Linux); it is not available on this platform, "
+              << "cannot watch " << options.directory << std::endl;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,159 @@
+// Build-time generator for the --glyphs structure bitmaps.
+//
+// Reads the glyph sheet (tools/glyph_sheet.txt, rendered from a font by
+// scripts/render_glyph_sheet.py), reduces every glyph's coverage samples to
+// kGlyphCols x kGlyphRows cells by box averaging, and writes the header with
+// kGlyphBitmaps that include/glyph_masks.h packs into bitmasks.
+//
+// Usage: gen_glyph_masks <glyph_sheet.txt> <glyph_bitmaps.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Must match include/glyph_masks.h
+constexpr int kGlyphCols = 4;
+constexpr int kGlyphRows = 8;
+
+// A cell is ink when at least this share of it is covered
+constexpr int kInkPercent = 30;
+
+struct SheetGlyph {
+    char character;
+    std::vector<std::string> rows;  // hex coverage digits, 0 = blank, f = full
+};
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool readSheet(const char* path, std::vector<SheetGlyph>& glyphs) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "[ERROR] Cannot open glyph sheet: " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        if (line.empty() || line[0] == '#') continue;
+        if (line.rfind("glyph ", 0) == 0 && line.size() == 7) {
+            glyphs.push_back(SheetGlyph{line[6], {}});
+            continue;
+        }
+        if (glyphs.empty()) {
+            std::cerr << "[ERROR] " << path << ":" << lineNo << ": samples before the first glyph" << std::endl;
+            return false;
+        }
+        for (char c : line) {
+            if (hexDigit(c) < 0) {
+                std::cerr << "[ERROR] " << path << ":" << lineNo << ": not a coverage digit: " << c << std::endl;
+                return false;
+            }
+        }
+        glyphs.back().rows.push_back(line);
+    }
+    if (glyphs.empty()) {
+        std::cerr << "[ERROR] No glyphs in " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// kGlyphCols * kGlyphRows '#'/'.' characters, row-major from the top
+bool reduceGlyph(const SheetGlyph& glyph, std::string& bitmap) {
+    const int height = static_cast<int>(glyph.rows.size());
+    const int width = height > 0 ? static_cast<int>(glyph.rows[0].size()) : 0;
+    if (height % kGlyphRows != 0 || width % kGlyphCols != 0 || width == 0) {
+        std::cerr << "[ERROR] Glyph '" << glyph.character << "' is " << width << "x" << height
+                  << ", not a multiple of " << kGlyphCols << "x" << kGlyphRows << std::endl;
+        return false;
+    }
+    for (const std::string& row : glyph.rows) {
+        if (static_cast<int>(row.size()) != width) {
+            std::cerr << "[ERROR] Glyph '" << glyph.character << "' has rows of different widths" << std::endl;
+            return false;
+        }
+    }
+
+    const int blockW = width / kGlyphCols;
+    const int blockH = height / kGlyphRows;
+    const int full = 15 * blockW * blockH;
+    bitmap.clear();
+    for (int cy = 0; cy < kGlyphRows; ++cy) {
+        for (int cx = 0; cx < kGlyphCols; ++cx) {
+            int sum = 0;
+            for (int y = cy * blockH; y < (cy + 1) * blockH; ++y) {
+                for (int x = cx * blockW; x < (cx + 1) * blockW; ++x) {
+                    sum += hexDigit(glyph.rows[y][x]);
+                }
+            }
+            bitmap += sum * 100 >= full * kInkPercent ? '#' : '.';
+        }
+    }
+    return true;
+}
+
+std::string charLiteral(char c) {
+    if (c == '\\' || c == '\'') return std::string("'\\") + c + "'";
+    return std::string("'") + c + "'";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <glyph_sheet.txt> <glyph_bitmaps.h>" << std::endl;
+        return 1;
+    }
+
+    std::vector<SheetGlyph> glyphs;
+    if (!readSheet(argv[1], glyphs)) return 1;
+
+    std::vector<std::string> seen;
+    std::string table;
+    for (const SheetGlyph& glyph : glyphs) {
+        std::string bitmap;
+        if (!reduceGlyph(glyph, bitmap)) return 1;
+        // Glyphs that reduce to an earlier glyph's mask would never be chosen
+        bool duplicate = false;
+        for (const std::string& other : seen) duplicate = duplicate || other == bitmap;
+        if (duplicate) {
+            std::cerr << "[gen_glyph_masks] '" << glyph.character << "' matches an earlier glyph at "
+                      << kGlyphCols << "x" << kGlyphRows << ", skipped" << std::endl;
+            continue;
+        }
+        seen.push_back(bitmap);
+
+        table += "    {" + charLiteral(glyph.character) + ", ";
+        table += std::string(glyph.character == '\\' || glyph.character == '\'' ? "" : " ");
+        for (int y = 0; y < kGlyphRows; ++y) {
+            table += (y > 0 ? " \"" : "\"") + bitmap.substr(y * kGlyphCols, kGlyphCols) + "\"";
+        }
+        table += "},\n";
+    }
+
+    std::ofstream out(argv[2]);
+    if (!out) {
+        std::cerr << "[ERROR] Cannot write " << argv[2] << std::endl;
+        return 1;
+    }
+    out << "// Generated by tools/gen_glyph_masks.cpp from tools/glyph_sheet.txt. Do not edit.\n"
+        << "#pragma once\n\n"
+        << "inline constexpr GlyphBitmap kGlyphBitmaps[] = {\n"
+        << table
+        << "};\n";
+    out.close();
+    if (!out) {
+        std::cerr << "[ERROR] Failed to write " << argv[2] << std::endl;
+        return 1;
+    }
+    return 0;
+}